@@ -0,0 +1,104 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+#if !defined(__cpp_lib_atomic_wait)
+	#if defined(_WIN32)
+		#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+		#endif
+		#ifndef NOMINMAX
+		#define NOMINMAX
+		#endif
+		#include <windows.h>
+		#pragma comment(lib, "Synchronization.lib")
+	#elif defined(__linux__)
+		#include <linux/futex.h>
+		#include <sys/syscall.h>
+		#include <unistd.h>
+	#endif
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	#include <intrin.h>
+#endif
+
+namespace adl
+{
+	namespace details
+	{
+		// Hint the processor that the thread is spinning
+		inline void cpu_relax()
+		{
+			#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+			_mm_pause();
+			#elif defined(__i386__) || defined(__x86_64__)
+			__builtin_ia32_pause();
+			#elif defined(__aarch64__) || defined(__arm__)
+			asm volatile("yield");
+			#else
+			std::this_thread::yield();
+			#endif
+		}
+
+		// Block the thread until the value is changed from expected one, may return spuriously
+		inline void atomic_wait(std::atomic<uint32_t>& value, uint32_t expected)
+		{
+			#if defined(__cpp_lib_atomic_wait)
+			value.wait(expected, std::memory_order_acquire);
+			#elif defined(_WIN32)
+			WaitOnAddress(&value, &expected, sizeof(expected), INFINITE);
+			#elif defined(__linux__)
+			syscall(SYS_futex, reinterpret_cast<uint32_t*>(&value), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+			#else
+			if (value.load(std::memory_order_acquire) == expected)
+			{
+				std::this_thread::yield();
+			}
+			#endif
+		}
+
+		inline void atomic_notify_one(std::atomic<uint32_t>& value)
+		{
+			#if defined(__cpp_lib_atomic_wait)
+			value.notify_one();
+			#elif defined(_WIN32)
+			WakeByAddressSingle(&value);
+			#elif defined(__linux__)
+			syscall(SYS_futex, reinterpret_cast<uint32_t*>(&value), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+			#endif
+		}
+
+		inline void atomic_notify_all(std::atomic<uint32_t>& value)
+		{
+			#if defined(__cpp_lib_atomic_wait)
+			value.notify_all();
+			#elif defined(_WIN32)
+			WakeByAddressAll(&value);
+			#elif defined(__linux__)
+			syscall(SYS_futex, reinterpret_cast<uint32_t*>(&value), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+			#endif
+		}
+
+		// Spin until predicate is satisfied, returns false if it is not satisfied after all spins
+		template<typename Predicate>
+		bool spin_until(Predicate&& predicate, size_t spins)
+		{
+			for (size_t i = 0; i < spins; ++i)
+			{
+				if (predicate())
+				{
+					return true;
+				}
+
+				cpu_relax();
+			}
+
+			return predicate();
+		}
+	}
+}
\ No newline at end of file
@@ -6,18 +6,42 @@
 namespace adl
 {
 
+// Threads which post to and dispatch the channel, executors with task queues pick the matching queue
+enum class Concurrency
+{
+    // Posted and dispatched by the same thread, no synchronization
+    SingleThread,
+    // One producer thread and one consumer thread, wait-free ring
+    SPSC,
+    // Many producer threads and one consumer thread, lock-free stack
+    MPSC,
+    // Any threads, executor is used as declared
+    MPMC
+};
+
+namespace details
+{
+    // Executor which is used by the channel with provided concurrency, specialized by the executors with task queues
+    template<typename ExecutorType, Concurrency ConcurrencyType>
+    struct concurrent_executor
+    {
+        using type = ExecutorType;
+    };
+}
+
 template<typename ChannelType>
 struct channel_info;
 
-template<typename ChannelIDType, ChannelIDType ID, typename ChannelExecutorType>
+template<typename ChannelIDType, ChannelIDType ID, typename ChannelExecutorType, Concurrency ConcurrencyType = Concurrency::MPMC>
 struct Channel;
 
-template<typename ChannelIDType, ChannelIDType ChannelID, typename ChannelExecutorType>
+template<typename ChannelIDType, ChannelIDType ChannelID, typename ChannelExecutorType, Concurrency ConcurrencyType>
 struct Channel
 {
     using id_t = ChannelIDType;
-    using executor_t = ChannelExecutorType;
+    using executor_t = typename details::concurrent_executor<ChannelExecutorType, ConcurrencyType>::type;
     static constexpr ChannelIDType ID = ChannelID;
+    static constexpr Concurrency concurrency = ConcurrencyType;
 };
 
 } // namespace adl
\ No newline at end of file
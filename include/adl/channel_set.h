@@ -0,0 +1,164 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include "dispatcher.h"
+#include "stop_token.h"
+#include "executors/run_loop.h"
+#include <array>
+#include <cstddef>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// Number of agents dispatched per unit of the channel weight in a round
+#ifndef ADL_DISPATCH_QUANTUM
+#define ADL_DISPATCH_QUANTUM 32
+#endif
+
+namespace adl
+{
+	namespace details
+	{
+		// Executor which can be checked for tasks without locks and forward its wakeups to a shared event
+		template<typename ExecutorType, typename = void>
+		struct has_shared_event : std::false_type {};
+
+		template<typename ExecutorType>
+		struct has_shared_event<ExecutorType, std::void_t<
+			decltype(bool{ std::declval<const ExecutorType&>().has_tasks() }),
+			decltype(std::declval<ExecutorType&>().set_shared_event(std::declval<EventCount*>()))>> : std::true_type {};
+
+		template<typename ExecutorType, typename = void>
+		struct has_dispatch_n : std::false_type {};
+
+		template<typename ExecutorType>
+		struct has_dispatch_n<ExecutorType, std::void_t<decltype(size_t{ std::declval<ExecutorType&>().dispatch_n(size_t{}) })>> : std::true_type {};
+
+		// Event shared by the executors of the channel list, static storage outlives the notifications which reach it late
+		template<typename... ChannelTypes>
+		inline EventCount shared_event;
+	}
+
+	// Set of channels dispatched by one thread. Channels are interleaved in rounds, every channel with tasks dispatches
+	// up to weight * ADL_DISPATCH_QUANTUM agents per round. The thread parks on a single event shared by the executors
+	// while all of them are idle. Channel list is known at compile time, so rounds are fully specialized.
+	template<typename... ChannelTypes>
+	class ChannelSet
+	{
+		static_assert(sizeof...(ChannelTypes) > 0, "Channel set should contain at least one channel");
+
+	public:
+
+		// Parking requires lock-free checks and shared wakeups from all executors, otherwise the thread yields
+		static constexpr bool can_park = (... && details::has_shared_event<typename ChannelTypes::executor_t>::value);
+
+		ChannelSet()
+		{
+			m_quanta.fill(ADL_DISPATCH_QUANTUM);
+		}
+
+		// Weight of the channel, zero excludes it from the rounds. Should be set from the dispatching thread.
+		template<typename ChannelType>
+		void set_weight(size_t weight)
+		{
+			m_quanta[index_of<ChannelType>(std::index_sequence_for<ChannelTypes...>{})] = weight * ADL_DISPATCH_QUANTUM;
+		}
+
+		// Dispatch a single round, empty channels are skipped. Returns true if some channel may have tasks left.
+		bool dispatch()
+		{
+			return dispatch_round(std::index_sequence_for<ChannelTypes...>{});
+		}
+
+		// Dispatch rounds until the stop is requested, the thread spins and then parks while all channels are idle
+		void run_until(const stop_token& token, size_t spins = ADL_RUN_SPIN_COUNT)
+		{
+			if constexpr (can_park)
+			{
+				details::EventCount& event = details::shared_event<ChannelTypes...>;
+
+				(..., get_executor<ChannelTypes>().set_shared_event(&event));
+				details::run_loop(event, token, spins, [this] { dispatch(); }, [this] { return has_tasks(std::index_sequence_for<ChannelTypes...>{}); });
+				(..., get_executor<ChannelTypes>().set_shared_event(nullptr));
+			}
+			else
+			{
+				while (!token.stop_requested())
+				{
+					if (!dispatch())
+					{
+						std::this_thread::yield();
+					}
+				}
+			}
+		}
+
+	private:
+
+		template<typename ChannelType, size_t... Indexes>
+		static constexpr size_t index_of(std::index_sequence<Indexes...>)
+		{
+			static_assert((false || ... || std::is_same_v<ChannelType, ChannelTypes>), "Channel is not in the set");
+			return (0 + ... + (std::is_same_v<ChannelType, ChannelTypes> ? Indexes : 0));
+		}
+
+		// Excluded channels don't keep the thread awake
+		template<size_t... Indexes>
+		bool has_tasks(std::index_sequence<Indexes...>) const
+		{
+			return (... || (m_quanta[Indexes] != 0 && get_executor<ChannelTypes>().has_tasks()));
+		}
+
+		template<size_t... Indexes>
+		bool dispatch_round(std::index_sequence<Indexes...>)
+		{
+			// Every channel is dispatched, the pending flags are combined afterwards
+			const bool pending[] = { dispatch_channel<ChannelTypes>(m_quanta[Indexes])... };
+			return (false || ... || pending[Indexes]);
+		}
+
+		template<typename ChannelType>
+		static bool dispatch_channel(size_t quantum)
+		{
+			using executor_t = typename ChannelType::executor_t;
+
+			auto& executor = get_executor<ChannelType>();
+
+			if constexpr (details::has_shared_event<executor_t>::value)
+			{
+				if (!executor.has_tasks())
+				{
+					return false;
+				}
+			}
+
+			if (quantum == 0)
+			{
+				return false;
+			}
+
+			details::DispatchScope dispatchScope{ &executor };
+
+			if constexpr (details::has_dispatch_n<executor_t>::value)
+			{
+				return executor.dispatch_n(quantum) != 0;
+			}
+			else
+			{
+				executor.dispatch();
+				return false;
+			}
+		}
+
+		std::array<size_t, sizeof...(ChannelTypes)> m_quanta;
+	};
+
+	// Dispatch a single round of the channels with equal weights, empty channels are skipped.
+	// Returns true if some channel may have tasks left.
+	template<typename... ChannelTypes>
+	bool dispatch_all()
+	{
+		return ChannelSet<ChannelTypes...>{}.dispatch();
+	}
+}
\ No newline at end of file
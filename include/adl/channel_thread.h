@@ -0,0 +1,270 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include "channel_set.h"
+#include "dispatcher.h"
+#include "stop_token.h"
+#include "executors/run_loop.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// Dispatch passes over the channels made by the stopped channel thread before it exits
+#ifndef ADL_CHANNEL_THREAD_DRAIN_PASSES
+#define ADL_CHANNEL_THREAD_DRAIN_PASSES 16
+#endif
+
+#if defined(_WIN32)
+	#ifndef WIN32_LEAN_AND_MEAN
+	#define WIN32_LEAN_AND_MEAN
+	#endif
+	#ifndef NOMINMAX
+	#define NOMINMAX
+	#endif
+	#include <windows.h>
+#elif defined(__linux__) || defined(__APPLE__)
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+namespace adl
+{
+	// How the channel thread waits when there are no tasks
+	enum class WaitStrategy
+	{
+		// Dispatch in a loop, lowest latency at the cost of a busy core
+		Spin,
+		// Yield the rest of the time slice between dispatches
+		Yield,
+		// Park the thread until a task is posted, falls back to Yield if the executor can't be run.
+		// Several channels are dispatched in weighted rounds and park on a shared event if all their executors support it.
+		Park
+	};
+
+	struct ChannelThreadOptions
+	{
+		WaitStrategy wait = WaitStrategy::Park;
+		// Spins before parking
+		size_t spins = ADL_RUN_SPIN_COUNT;
+		// Thread name shown by debuggers and profilers, not set if empty
+		std::string name;
+		// Mask of the CPUs the thread may run on, not set if zero
+		uint64_t affinity = 0;
+		// Native priority, THREAD_PRIORITY_* value on Windows and SCHED_FIFO priority elsewhere, not set if zero
+		int priority = 0;
+	};
+
+	namespace details
+	{
+		template<typename ExecutorType, typename = void>
+		struct has_run_until : std::false_type {};
+
+		template<typename ExecutorType>
+		struct has_run_until<ExecutorType, std::void_t<decltype(std::declval<ExecutorType&>().run_until(std::declval<const stop_token&>(), size_t{}))>> : std::true_type {};
+
+		// Thread settings are applied on a best effort basis, failures are ignored
+		inline void set_current_thread_name(const std::string& name)
+		{
+			#if defined(_WIN32)
+			SetThreadDescription(GetCurrentThread(), std::wstring(name.begin(), name.end()).c_str());
+			#elif defined(__APPLE__)
+			pthread_setname_np(name.c_str());
+			#elif defined(__linux__)
+			// Linux limits names to 15 characters
+			pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+			#else
+			(void)name;
+			#endif
+		}
+
+		inline void set_current_thread_affinity(uint64_t mask)
+		{
+			#if defined(_WIN32)
+			SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(mask));
+			#elif defined(__linux__)
+			cpu_set_t cpus;
+			CPU_ZERO(&cpus);
+
+			for (size_t cpu = 0; cpu < 64; ++cpu)
+			{
+				if (mask & (uint64_t{ 1 } << cpu))
+				{
+					CPU_SET(cpu, &cpus);
+				}
+			}
+
+			pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+			#else
+			(void)mask;
+			#endif
+		}
+
+		inline void set_current_thread_priority(int priority)
+		{
+			#if defined(_WIN32)
+			SetThreadPriority(GetCurrentThread(), priority);
+			#elif defined(__linux__) || defined(__APPLE__)
+			sched_param param{};
+			param.sched_priority = priority;
+			pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+			#else
+			(void)priority;
+			#endif
+		}
+	}
+
+	// Owns a thread which dispatches the channels until stopped. Tasks which are still queued on stop
+	// are executed by the thread before it exits, within ADL_CHANNEL_THREAD_DRAIN_PASSES passes. Tasks which
+	// are deferred or posted again on every pass are left in the channels for the next dispatch or the
+	// destruction of the executor. Works with any executor which has dispatch().
+	template<typename... ChannelTypes>
+	class ChannelThread
+	{
+		static_assert(sizeof...(ChannelTypes) > 0, "Channel thread should dispatch at least one channel");
+
+	public:
+
+		explicit ChannelThread(ChannelThreadOptions options = {})
+			: m_thread{ [this, options = std::move(options)] { run(options); } }
+		{}
+
+		ChannelThread(const ChannelThread&) = delete;
+		ChannelThread& operator=(const ChannelThread&) = delete;
+
+		~ChannelThread()
+		{
+			stop();
+		}
+
+		// Stop dispatching, drain the channels and join the thread
+		void stop()
+		{
+			if (m_thread.joinable())
+			{
+				m_stop.request_stop();
+				m_thread.join();
+			}
+		}
+
+		std::thread::id get_id() const
+		{
+			return m_thread.get_id();
+		}
+
+		std::thread::native_handle_type native_handle()
+		{
+			return m_thread.native_handle();
+		}
+
+	private:
+
+		static constexpr bool can_park = sizeof...(ChannelTypes) == 1
+			? (... && details::has_run_until<typename ChannelTypes::executor_t>::value)
+			: ChannelSet<ChannelTypes...>::can_park;
+
+		void run(const ChannelThreadOptions& options)
+		{
+			if (!options.name.empty())
+			{
+				details::set_current_thread_name(options.name);
+			}
+
+			if (options.affinity != 0)
+			{
+				details::set_current_thread_affinity(options.affinity);
+			}
+
+			if (options.priority != 0)
+			{
+				details::set_current_thread_priority(options.priority);
+			}
+
+			const stop_token token = m_stop.get_token();
+
+			if constexpr (can_park)
+			{
+				if (options.wait == WaitStrategy::Park)
+				{
+					if constexpr (sizeof...(ChannelTypes) == 1)
+					{
+						(..., park_channel<ChannelTypes>(token, options.spins));
+					}
+					else
+					{
+						ChannelSet<ChannelTypes...>{}.run_until(token, options.spins);
+					}
+				}
+			}
+
+			while (!token.stop_requested())
+			{
+				(..., dispatch<ChannelTypes>());
+
+				if (options.wait != WaitStrategy::Spin)
+				{
+					std::this_thread::yield();
+				}
+			}
+
+			drain();
+		}
+
+		template<typename ChannelType>
+		static void park_channel(const stop_token& token, size_t spins)
+		{
+			auto& executor = get_executor<ChannelType>();
+			details::DispatchScope dispatchScope{ &executor };
+			executor.run_until(token, spins);
+		}
+
+		// Tasks posted by the drained tasks are executed too, so channels can hand over work to each other.
+		// Passes are bounded, so a task which defers itself forever doesn't keep the thread alive.
+		static void drain()
+		{
+			for (size_t pass = 0; pass < ADL_CHANNEL_THREAD_DRAIN_PASSES; ++pass)
+			{
+				(..., drain_channel<ChannelTypes>());
+
+				if (!(false || ... || has_tasks<ChannelTypes>()))
+				{
+					return;
+				}
+			}
+		}
+
+		template<typename ChannelType>
+		static void drain_channel()
+		{
+			if constexpr (details::has_dispatch_n<typename ChannelType::executor_t>::value)
+			{
+				dispatch_n<ChannelType>(std::numeric_limits<size_t>::max());
+			}
+			else
+			{
+				dispatch<ChannelType>();
+			}
+		}
+
+		// Executors without dispatch_n are drained by a single dispatch
+		template<typename ChannelType>
+		static bool has_tasks()
+		{
+			if constexpr (details::has_dispatch_n<typename ChannelType::executor_t>::value)
+			{
+				return get_executor<ChannelType>().dispatch_n(0) != 0;
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		stop_source m_stop;
+		std::thread m_thread;
+	};
+}
\ No newline at end of file
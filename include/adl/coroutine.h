@@ -0,0 +1,478 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+
+// Coroutines are available only in C++20, the header is empty otherwise
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define ADL_HAS_COROUTINES 1
+#else
+#define ADL_HAS_COROUTINES 0
+#endif
+
+#if ADL_HAS_COROUTINES
+#include "dispatcher.h"
+#include "future.h"
+#include "placeholder.h"
+#include "priority.h"
+#include "task.h"
+#include <array>
+#include <cassert>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// Number of released coroutine frames of each size class cached per thread for reuse, 0 disables pooling
+#ifndef ADL_COROUTINE_FRAME_POOL_CAPACITY
+#define ADL_COROUTINE_FRAME_POOL_CAPACITY 64
+#endif
+
+// Frames larger than this are not pooled, the size is rounded up to a multiple of 64 bytes
+#ifndef ADL_COROUTINE_FRAME_POOL_MAX_SIZE
+#define ADL_COROUTINE_FRAME_POOL_MAX_SIZE 1024
+#endif
+
+namespace adl
+{
+	template<typename T>
+	class co_task;
+
+	namespace details
+	{
+		// Coroutine frames are pooled by size classes, a frame released by another thread is cached by that thread
+		class FramePool
+		{
+		public:
+
+			static void* allocate(std::size_t size)
+			{
+				if (is_pooled(size))
+				{
+					return pools()[size_class(size)].allocate();
+				}
+
+				return ::operator new(size);
+			}
+
+			static void deallocate(void* frame, std::size_t size)
+			{
+				if (is_pooled(size))
+				{
+					pools()[size_class(size)].deallocate(frame);
+				}
+				else
+				{
+					::operator delete(frame);
+				}
+			}
+
+		private:
+
+			static constexpr std::size_t GRANULARITY = 64;
+			static constexpr std::size_t CLASSES = ADL_COROUTINE_FRAME_POOL_MAX_SIZE / GRANULARITY;
+
+			struct Pool
+			{
+				void* (*allocate)();
+				void (*deallocate)(void*);
+			};
+
+			static bool is_pooled(std::size_t size)
+			{
+				return ADL_COROUTINE_FRAME_POOL_CAPACITY > 0 && size != 0 && size <= CLASSES * GRANULARITY;
+			}
+
+			static std::size_t size_class(std::size_t size)
+			{
+				return (size - 1) / GRANULARITY;
+			}
+
+			template<std::size_t... Classes>
+			static constexpr std::array<Pool, CLASSES> make_pools(std::index_sequence<Classes...>)
+			{
+				return { Pool{ &ThreadLocalPool<(Classes + 1) * GRANULARITY, ADL_COROUTINE_FRAME_POOL_CAPACITY>::allocate,
+					&ThreadLocalPool<(Classes + 1) * GRANULARITY, ADL_COROUTINE_FRAME_POOL_CAPACITY>::deallocate }... };
+			}
+
+			static const std::array<Pool, CLASSES>& pools()
+			{
+				static constexpr std::array<Pool, CLASSES> pools = make_pools(std::make_index_sequence<CLASSES>{});
+				return pools;
+			}
+		};
+
+		class CoTaskPromiseBase
+		{
+		public:
+
+			// Resume the awaiting coroutine, detached coroutine releases its own frame
+			struct FinalAwaiter
+			{
+				bool await_ready() const noexcept
+				{
+					return false;
+				}
+
+				template<typename Promise>
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> coroutine) noexcept
+				{
+					CoTaskPromiseBase& promise = coroutine.promise();
+
+					if (promise.m_continuation)
+					{
+						return promise.m_continuation;
+					}
+
+					if (promise.m_detached)
+					{
+						coroutine.destroy();
+					}
+
+					return std::noop_coroutine();
+				}
+
+				void await_resume() const noexcept {}
+			};
+
+			static void* operator new(std::size_t size)
+			{
+				return FramePool::allocate(size);
+			}
+
+			static void operator delete(void* frame, std::size_t size)
+			{
+				FramePool::deallocate(frame, size);
+			}
+
+			// Coroutine is started when it's awaited or submitted
+			std::suspend_always initial_suspend() const noexcept
+			{
+				return {};
+			}
+
+			FinalAwaiter final_suspend() const noexcept
+			{
+				return {};
+			}
+
+			// Exceptions are not used by the library
+			void unhandled_exception() const
+			{
+				std::terminate();
+			}
+
+		private:
+
+			template<typename T>
+			friend class adl::co_task;
+
+			std::coroutine_handle<> m_continuation;
+			bool m_detached = false;
+		};
+
+		template<typename T>
+		class CoTaskPromise : public CoTaskPromiseBase
+		{
+		public:
+
+			co_task<T> get_return_object();
+
+			template<typename U>
+			void return_value(U&& value)
+			{
+				m_value.emplace(std::forward<U>(value));
+			}
+
+			T take()
+			{
+				return std::move(*m_value);
+			}
+
+		private:
+
+			std::optional<T> m_value;
+		};
+
+		template<>
+		class CoTaskPromise<void> : public CoTaskPromiseBase
+		{
+		public:
+
+			co_task<void> get_return_object();
+
+			void return_void() const {}
+
+			void take() const {}
+		};
+
+		// Resume the coroutine from the channel executor with priority of the suspended agent
+		template<typename ChannelType>
+		struct ScheduleAwaiter
+		{
+			// Coroutine continues right away if the current thread already dispatches the channel
+			bool await_ready() const
+			{
+				return is_current_channel<ChannelType>();
+			}
+
+			void await_suspend(std::coroutine_handle<> coroutine) const
+			{
+				post<ChannelType>(current_priority(), [coroutine] { coroutine.resume(); });
+			}
+
+			void await_resume() const {}
+		};
+
+		// Receives the result of the awaited task and resumes the coroutine on the thread which completed it.
+		// It isn't generic, so it's never invoked with execution context.
+		template<typename AwaiterType>
+		struct ResumeSink
+		{
+			using value_t = typename AwaiterType::value_t;
+
+			template<typename T = value_t, typename = std::enable_if_t<!is_placeholder_v<T>>>
+			void operator()(value_t result) const
+			{
+				awaiter->m_result.emplace(std::move(result));
+				awaiter->m_coroutine.resume();
+			}
+
+			template<typename T = value_t, typename = std::enable_if_t<is_placeholder_v<T>>>
+			void operator()() const
+			{
+				awaiter->m_result.emplace();
+				awaiter->m_coroutine.resume();
+			}
+
+			AwaiterType* awaiter;
+		};
+
+		// Submit the task when the coroutine is suspended, the coroutine is resumed by its last continuation
+		template<typename TaskType>
+		class TaskAwaiter
+		{
+		public:
+
+			using value_t = task_result_t<TaskType>;
+
+			explicit TaskAwaiter(TaskType&& task)
+				: m_task{ std::move(task) }
+			{}
+
+			bool await_ready() const
+			{
+				return false;
+			}
+
+			// Awaiter may be released by the resumed coroutine before the submit returns, so it's not touched after it
+			void await_suspend(std::coroutine_handle<> coroutine)
+			{
+				m_coroutine = coroutine;
+				std::move(m_task).then(ResumeSink<TaskAwaiter>{ this }).submit();
+			}
+
+			auto await_resume()
+			{
+				if constexpr (!is_placeholder_v<value_t>)
+				{
+					return std::move(*m_result);
+				}
+			}
+
+		private:
+
+			friend struct ResumeSink<TaskAwaiter>;
+
+			TaskType m_task;
+			std::optional<value_t> m_result;
+			std::coroutine_handle<> m_coroutine;
+		};
+
+		// Resume the coroutine on the thread which sets the value of the future.
+		// If the promise is broken, the coroutine is never resumed.
+		template<typename T>
+		class FutureAwaiter
+		{
+		public:
+
+			using value_t = void_to_placeholder_t<T>;
+
+			explicit FutureAwaiter(future<T>&& future)
+				: m_future{ std::move(future) }
+			{}
+
+			bool await_ready() const
+			{
+				return m_future.is_ready();
+			}
+
+			void await_suspend(std::coroutine_handle<> coroutine)
+			{
+				m_coroutine = coroutine;
+
+				m_future.template then<void>(ResumeSink<FutureAwaiter>{ this });
+			}
+
+			T await_resume()
+			{
+				if (m_result.has_value())
+				{
+					if constexpr (!std::is_void_v<T>)
+					{
+						return std::move(*m_result);
+					}
+				}
+				else
+				{
+					return m_future.get();
+				}
+			}
+
+		private:
+
+			friend struct ResumeSink<FutureAwaiter>;
+
+			future<T> m_future;
+			std::optional<value_t> m_result;
+			std::coroutine_handle<> m_coroutine;
+		};
+	}
+
+	// Lazy coroutine, it's started when awaited or submitted. Frames are allocated from the per-thread pool,
+	// so switching channels with co_await adl::schedule<Channel>() costs a single post.
+	template<typename T = void>
+	class co_task
+	{
+	public:
+
+		using promise_type = details::CoTaskPromise<T>;
+
+		co_task(const co_task&) = delete;
+		co_task& operator=(const co_task&) = delete;
+
+		co_task(co_task&& other) noexcept
+			: m_coroutine{ std::exchange(other.m_coroutine, nullptr) }
+		{}
+
+		co_task& operator=(co_task&& other) noexcept
+		{
+			if (this != &other)
+			{
+				reset();
+				m_coroutine = std::exchange(other.m_coroutine, nullptr);
+			}
+
+			return *this;
+		}
+
+		~co_task()
+		{
+			reset();
+		}
+
+		// Start the coroutine in the current thread, it releases its frame when completed, the result is dropped
+		void submit() &&
+		{
+			assert(m_coroutine);
+
+			m_coroutine.promise().m_detached = true;
+			std::exchange(m_coroutine, nullptr).resume();
+		}
+
+		// Start the coroutine in provided channel, it releases its frame when completed, the result is dropped
+		template<typename ChannelType>
+		void submit() &&
+		{
+			assert(m_coroutine);
+
+			m_coroutine.promise().m_detached = true;
+			post<ChannelType>(details::current_priority(), [coroutine = std::exchange(m_coroutine, nullptr)] { coroutine.resume(); });
+		}
+
+		// Awaiting coroutine is resumed by the completed one in the same thread
+		auto operator co_await() && noexcept
+		{
+			struct Awaiter
+			{
+				bool await_ready() const noexcept
+				{
+					return false;
+				}
+
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+				{
+					coroutine.promise().m_continuation = awaiting;
+					return coroutine;
+				}
+
+				T await_resume()
+				{
+					return coroutine.promise().take();
+				}
+
+				std::coroutine_handle<promise_type> coroutine;
+			};
+
+			assert(m_coroutine);
+			return Awaiter{ m_coroutine };
+		}
+
+	private:
+
+		friend class details::CoTaskPromise<T>;
+
+		explicit co_task(std::coroutine_handle<promise_type> coroutine)
+			: m_coroutine{ coroutine }
+		{}
+
+		void reset()
+		{
+			if (m_coroutine)
+			{
+				std::exchange(m_coroutine, nullptr).destroy();
+			}
+		}
+
+		std::coroutine_handle<promise_type> m_coroutine;
+	};
+
+	namespace details
+	{
+		template<typename T>
+		co_task<T> CoTaskPromise<T>::get_return_object()
+		{
+			return co_task<T>{ std::coroutine_handle<CoTaskPromise<T>>::from_promise(*this) };
+		}
+
+		inline co_task<void> CoTaskPromise<void>::get_return_object()
+		{
+			return co_task<void>{ std::coroutine_handle<CoTaskPromise<void>>::from_promise(*this) };
+		}
+	}
+
+	// Resume the awaiting coroutine in provided channel
+	template<typename ChannelType>
+	details::ScheduleAwaiter<ChannelType> schedule()
+	{
+		return {};
+	}
+
+	// Submit the task and resume the awaiting coroutine with its result in the channel of its last continuation
+	template<typename TaskType, typename = std::enable_if_t<details::is_task_wrapper_v<TaskType> && !std::is_lvalue_reference_v<TaskType>>>
+	details::TaskAwaiter<std::decay_t<TaskType>> operator co_await(TaskType&& task)
+	{
+		return details::TaskAwaiter<std::decay_t<TaskType>>{ std::move(task) };
+	}
+
+	// Resume the awaiting coroutine with the value of the future in the thread which sets it
+	template<typename T>
+	details::FutureAwaiter<T> operator co_await(future<T>&& future)
+	{
+		return details::FutureAwaiter<T>{ std::move(future) };
+	}
+}
+#endif
\ No newline at end of file
@@ -3,27 +3,264 @@
 
 #pragma once
 #include "channel.h"
+#include "priority.h"
+#include "stop_token.h"
+#include "executors/execution_agent.h"
 #include "executors/inline_executor.h"
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// Channel executors are constructed before main unless ADL_EXPLICIT_EXECUTORS is set,
+// then they should be constructed with construct_executors() or ExecutorScope before they are used
+#ifndef ADL_EXPLICIT_EXECUTORS
+#define ADL_EXPLICIT_EXECUTORS 0
+#endif
+
+#if defined(__cpp_constinit)
+#define ADL_CONSTINIT constinit
+#else
+#define ADL_CONSTINIT
+#endif
+
+// Maximum depth of the nested same-channel continuations invoked inline, deeper continuations are posted
+#ifndef ADL_MAX_INLINE_HOPS
+#define ADL_MAX_INLINE_HOPS 16
+#endif
 
 namespace adl
 {
 
-// Return executor instance for provided channel
+namespace details
+{
+	// Executor dispatched by the current thread and depth of the continuations invoked inline by it
+	struct CurrentChannel
+	{
+		const void* executor = nullptr;
+		size_t depth = 0;
+	};
+
+	inline CurrentChannel& current_channel()
+	{
+		static thread_local CurrentChannel channel;
+		return channel;
+	}
+
+	// Mark the executor as dispatched by the current thread until destroyed, nested dispatches restore the previous one
+	class DispatchScope
+	{
+	public:
+
+		explicit DispatchScope(const void* executor)
+			: m_previous{ current_channel().executor }
+		{
+			current_channel().executor = executor;
+		}
+
+		DispatchScope(const DispatchScope&) = delete;
+		DispatchScope& operator=(const DispatchScope&) = delete;
+
+		~DispatchScope()
+		{
+			current_channel().executor = m_previous;
+		}
+
+	private:
+
+		const void* const m_previous;
+	};
+
+	// Count the inline invocation in the depth of the current thread until destroyed
+	class InlineDepthScope
+	{
+	public:
+
+		explicit InlineDepthScope(CurrentChannel& current)
+			: m_current{ current }
+		{
+			++m_current.depth;
+		}
+
+		InlineDepthScope(const InlineDepthScope&) = delete;
+		InlineDepthScope& operator=(const InlineDepthScope&) = delete;
+
+		~InlineDepthScope()
+		{
+			--m_current.depth;
+		}
+
+	private:
+
+		CurrentChannel& m_current;
+	};
+
+	// Executor which accepts priority of the posted execution agent
+	template<typename ExecutorType, typename = void>
+	struct has_priorities : std::false_type {};
+
+	template<typename ExecutorType>
+	struct has_priorities<ExecutorType, std::void_t<decltype(std::declval<ExecutorType&>().execute(Priority{}, std::declval<void(*)()>()))>> : std::true_type {};
+}
+
+namespace details
+{
+	// Storage of the channel executor, it's constant initialized, so the executor can be constructed and destroyed explicitly
+	template<typename ExecutorType>
+	class ExecutorStorage
+	{
+	public:
+
+		constexpr ExecutorStorage() noexcept = default;
+
+		ExecutorStorage(const ExecutorStorage&) = delete;
+		ExecutorStorage& operator=(const ExecutorStorage&) = delete;
+
+		ExecutorType& get()
+		{
+			assert(m_constructed && "Executor is used before it's constructed or after it's destroyed");
+			return *std::launder(reinterpret_cast<ExecutorType*>(&m_storage));
+		}
+
+		bool constructed() const
+		{
+			return m_constructed;
+		}
+
+		void construct()
+		{
+			if (!m_constructed)
+			{
+				new (&m_storage) ExecutorType;
+				m_constructed = true;
+			}
+		}
+
+		// Hook is called before the executor is destroyed, so the services which post to it can be stopped first
+		void set_destroy_hook(void (*hook)())
+		{
+			m_destroyHook = hook;
+		}
+
+		void destroy()
+		{
+			if (m_constructed)
+			{
+				if (m_destroyHook != nullptr)
+				{
+					m_destroyHook();
+				}
+
+				get().~ExecutorType();
+				m_constructed = false;
+			}
+		}
+
+	private:
+
+		alignas(ExecutorType) unsigned char m_storage[sizeof(ExecutorType)]{};
+		bool m_constructed = false;
+		void (*m_destroyHook)() = nullptr;
+	};
+
+	// One executor per channel in the whole process
+	template<typename ChannelType>
+	inline ADL_CONSTINIT ExecutorStorage<typename ChannelType::executor_t> executor_storage{};
+
+	// Constructs the executor before main and destroys it at exit, unless it's destroyed explicitly before
+	template<typename ChannelType>
+	struct ExecutorLifetime
+	{
+		ExecutorLifetime()
+		{
+			#if !ADL_EXPLICIT_EXECUTORS
+			executor_storage<ChannelType>.construct();
+			#endif
+		}
+
+		~ExecutorLifetime()
+		{
+			executor_storage<ChannelType>.destroy();
+		}
+	};
+
+	template<typename ChannelType>
+	inline ExecutorLifetime<ChannelType> executor_lifetime{};
+}
+
+// Return executor instance for provided channel, it's the same in all translation units.
+// Executor is accessed without initialization guard, so it shouldn't be used by the static initializers unless it's constructed by them explicitly.
 template<typename ChannelType>
-static auto& get_executor()
+inline auto& get_executor()
 {
-	static ChannelType::executor_t executor;
-	return executor;
+	// Instantiates the lifetime of the executor, nothing is executed here
+	(void)&details::executor_lifetime<ChannelType>;
+	return details::executor_storage<ChannelType>.get();
 }
 
 // Return inline executor if channel is not provided
 template<>
-static auto& get_executor<void>()
+inline auto& get_executor<void>()
 {
 	static InlineExecutor executor;
 	return executor;
 }
 
+// Construct the executors of the channels in provided order, constructed executors are skipped.
+// Should be called before the channels are used by other threads.
+template<typename... ChannelTypes>
+void construct_executors()
+{
+	(..., details::executor_storage<ChannelTypes>.construct());
+}
+
+// Destroy the executors of the channels in provided order, pending agents are dropped.
+// Should be called after the channels are not used by other threads.
+template<typename... ChannelTypes>
+void destroy_executors()
+{
+	(..., details::executor_storage<ChannelTypes>.destroy());
+}
+
+// Construct the executors of the channels in provided order and destroy them in reverse order
+template<typename... ChannelTypes>
+class ExecutorScope
+{
+public:
+
+	ExecutorScope()
+	{
+		construct_executors<ChannelTypes...>();
+	}
+
+	ExecutorScope(const ExecutorScope&) = delete;
+	ExecutorScope& operator=(const ExecutorScope&) = delete;
+
+	~ExecutorScope()
+	{
+		destroy_reversed(std::index_sequence_for<ChannelTypes...>{});
+	}
+
+private:
+
+	template<size_t... Indexes>
+	static void destroy_reversed(std::index_sequence<Indexes...>)
+	{
+		using channels_t = std::tuple<ChannelTypes...>;
+		destroy_executors<std::tuple_element_t<sizeof...(ChannelTypes) - 1 - Indexes, channels_t>...>();
+	}
+};
+
+// Returns true if the current thread dispatches provided channel
+template<typename ChannelType>
+static bool is_current_channel()
+{
+    return details::current_channel().executor == &get_executor<ChannelType>();
+}
+
 // Submit execution agent for one-way execution in provided channel
 template<typename ChannelType, typename CallableType>
 static void post(CallableType&& callable)
@@ -31,6 +268,56 @@ static void post(CallableType&& callable)
     get_executor<ChannelType>().execute(std::forward<CallableType>(callable));
 }
 
+// Invoke execution agent inline if the current thread already dispatches provided channel, otherwise post it.
+// Nested inline invocations are limited by ADL_MAX_INLINE_HOPS, so the stack doesn't grow without bound.
+template<typename ChannelType, typename CallableType>
+static void post_or_invoke(CallableType&& callable)
+{
+    details::CurrentChannel& current = details::current_channel();
+
+    if (current.depth < ADL_MAX_INLINE_HOPS && is_current_channel<ChannelType>())
+    {
+        // Agent is moved or copied like it would be by the executor
+        std::decay_t<CallableType> agent{ std::forward<CallableType>(callable) };
+
+        // Depth is restored even if the agent throws
+        details::InlineDepthScope depthScope{ current };
+        agent();
+    }
+    else
+    {
+        post<ChannelType>(std::forward<CallableType>(callable));
+    }
+}
+
+// Submit execution agent with priority for one-way execution in provided channel.
+// Executors without priorities ignore it, but the agents posted from inline executed agent inherit it.
+template<typename ChannelType, typename CallableType>
+static void post(Priority priority, CallableType&& callable)
+{
+    auto& executor = get_executor<ChannelType>();
+
+    if constexpr (details::has_priorities<std::decay_t<decltype(executor)>>::value)
+    {
+        executor.execute(priority, std::forward<CallableType>(callable));
+    }
+    else
+    {
+        details::PriorityScope priorityScope{ priority };
+        executor.execute(std::forward<CallableType>(callable));
+    }
+}
+
+namespace details
+{
+	// Post function which can be stored by the timers and events, they post the parked agents later from other threads
+	template<typename ChannelType>
+	void post_agent(Priority priority, ExecutionAgent<>&& agent)
+	{
+		post<ChannelType>(priority, std::move(agent));
+	}
+}
+
 // Submit execution agent for one-way deferred execution in provided channel
 template<typename ChannelType, typename CallableType>
 static void post_defer(CallableType&& callable)
@@ -52,6 +339,23 @@ static auto post_future(CallableType&& callable)
     return get_executor<ChannelType>().future_execute(std::forward<CallableType>(callable));
 }
 
+// Submit execution agent with priority for two-way execution in provided channel, executors without priorities ignore it
+template<typename ChannelType, typename CallableType>
+static auto post_future(Priority priority, CallableType&& callable)
+{
+    auto& executor = get_executor<ChannelType>();
+
+    if constexpr (details::has_priorities<std::decay_t<decltype(executor)>>::value)
+    {
+        return executor.future_execute(priority, std::forward<CallableType>(callable));
+    }
+    else
+    {
+        details::PriorityScope priorityScope{ priority };
+        return executor.future_execute(std::forward<CallableType>(callable));
+    }
+}
+
 // Submit a group of execution agents for two-way execution in provided channel
 template<typename ChannelType, typename... CallableTypes>
 static auto post_future_bulk(CallableTypes&&... callables)
@@ -63,7 +367,59 @@ static auto post_future_bulk(CallableTypes&&... callables)
 template<typename ChannelType>
 static void dispatch()
 {
-    get_executor<ChannelType>().dispatch();
+    auto& executor = get_executor<ChannelType>();
+    details::DispatchScope dispatchScope{ &executor };
+    executor.dispatch();
+}
+
+// Dispatch execution agents for provided channel until the time budget is spent, returns the number of remaining agents
+template<typename ChannelType, typename Rep, typename Period>
+static size_t dispatch_for(std::chrono::duration<Rep, Period> duration)
+{
+    auto& executor = get_executor<ChannelType>();
+    details::DispatchScope dispatchScope{ &executor };
+    return executor.dispatch_for(duration);
+}
+
+// Dispatch at most count execution agents for provided channel, returns the number of remaining agents
+template<typename ChannelType>
+static size_t dispatch_n(size_t count)
+{
+    auto& executor = get_executor<ChannelType>();
+    details::DispatchScope dispatchScope{ &executor };
+    return executor.dispatch_n(count);
+}
+
+// Dispatch execution agents for provided channel until the stop is requested, the thread is parked while there are no agents
+template<typename ChannelType>
+static void run_until(const stop_token& token)
+{
+    auto& executor = get_executor<ChannelType>();
+    details::DispatchScope dispatchScope{ &executor };
+    executor.run_until(token);
+}
+
+// Dispatch execution agents for provided channel until stop<ChannelType>() is called
+template<typename ChannelType>
+static void run()
+{
+    auto& executor = get_executor<ChannelType>();
+    details::DispatchScope dispatchScope{ &executor };
+    executor.run();
+}
+
+// Return from all run() calls of provided channel
+template<typename ChannelType>
+static void stop()
+{
+    get_executor<ChannelType>().stop();
+}
+
+// Return snapshot of the executor statistics for provided channel, statistics are collected if ADL_EXECUTOR_STATS is enabled
+template<typename ChannelType>
+static ExecutorStats stats()
+{
+    return get_executor<ChannelType>().stats();
 }
 
 } // namespace adl
\ No newline at end of file
@@ -0,0 +1,97 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include "dispatcher.h"
+#include "priority.h"
+#include "executors/execution_agent.h"
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace adl
+{
+	// Manual reset event which parks execution agents instead of blocking threads.
+	// Parked agents are posted to their channels by the thread which sets the event.
+	class event
+	{
+	public:
+
+		event() = default;
+
+		explicit event(bool set)
+			: m_set{ set }
+		{}
+
+		event(const event&) = delete;
+		event& operator=(const event&) = delete;
+
+		// Event stays set until reset, agents parked on the set event are posted immediately
+		void set()
+		{
+			std::vector<Waiter> waiters;
+
+			{
+				std::unique_lock lock{ m_mutex };
+				m_set = true;
+				waiters.swap(m_waiters);
+			}
+
+			for (auto&& waiter : waiters)
+			{
+				waiter.post(waiter.priority, std::move(waiter.agent));
+			}
+		}
+
+		void reset()
+		{
+			std::unique_lock lock{ m_mutex };
+			m_set = false;
+		}
+
+		bool is_set() const
+		{
+			std::unique_lock lock{ m_mutex };
+			return m_set;
+		}
+
+		// Post execution agent to provided channel when the event is set, priority of the current agent is preserved
+		template<typename ChannelType, typename CallableType>
+		void post_when_set(CallableType&& callable)
+		{
+			const Priority priority = details::current_priority();
+
+			{
+				std::unique_lock lock{ m_mutex };
+
+				if (!m_set)
+				{
+					m_waiters.push_back({ &details::post_agent<ChannelType>, priority, ExecutionAgent<>{ std::forward<CallableType>(callable) } });
+					return;
+				}
+			}
+
+			post<ChannelType>(priority, std::forward<CallableType>(callable));
+		}
+
+		// Number of parked agents
+		size_t size() const
+		{
+			std::unique_lock lock{ m_mutex };
+			return m_waiters.size();
+		}
+
+	private:
+
+		struct Waiter
+		{
+			void (*post)(Priority, ExecutionAgent<>&&);
+			Priority priority;
+			ExecutionAgent<> agent;
+		};
+
+		mutable std::mutex m_mutex;
+		bool m_set = false;
+		std::vector<Waiter> m_waiters;
+	};
+}
\ No newline at end of file
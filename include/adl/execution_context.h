@@ -3,9 +3,12 @@
 
 #pragma once
 #include "placeholder.h"
+#include <chrono>
 
 namespace adl
 {
+	class event;
+
 	class ExecutionContext
 	{
 	public:
@@ -16,9 +19,34 @@ namespace adl
 		// Defer task, executor should support deferred execution
 		void defer() { m_state = State::Deferred; }
 
+		// Defer task for the duration, task is parked in the timer executor instead of being posted again until then
+		template<typename Rep, typename Period>
+		void defer_for(std::chrono::duration<Rep, Period> duration)
+		{
+			m_state = State::DeferredFor;
+			m_deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(duration);
+		}
+
+		// Defer task until the event is set, task is parked in the event. Event should outlive the parked task.
+		void defer_until(event& e)
+		{
+			m_state = State::DeferredUntil;
+			m_event = &e;
+		}
+
 		bool is_canceled() const { return m_state == State::Canceled; }
 
-		bool is_deferred() const { return m_state == State::Deferred; }
+		bool is_deferred() const { return m_state >= State::Deferred; }
+
+		// Task is parked until the deadline
+		bool is_deferred_for() const { return m_state == State::DeferredFor; }
+
+		std::chrono::steady_clock::time_point deadline() const { return m_deadline; }
+
+		// Task is parked until the event is set
+		bool is_deferred_until() const { return m_state == State::DeferredUntil; }
+
+		event& deferred_event() const { return *m_event; }
 
 	private:
 
@@ -26,10 +54,14 @@ namespace adl
 		{
 			Valid,
 			Canceled,
-			Deferred
+			Deferred,
+			DeferredFor,
+			DeferredUntil
 		};
 
 		State m_state = State::Valid;
+		std::chrono::steady_clock::time_point m_deadline;
+		event* m_event = nullptr;
 	};
 
 	namespace details
@@ -2,84 +2,198 @@
 // MIT License | https://opensource.org/licenses/MIT
 
 #pragma once
-#include <future>
+#include "executor.h"
+#include "execution_agent.h"
+#include "executor_stats.h"
+#include "task_queue.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
-#include <list>
+#include <thread>
+#include <vector>
+
+// Default limit of threads which can be spawned by AsyncExecutor
+#ifndef ADL_ASYNC_EXECUTOR_MAX_THREADS
+#define ADL_ASYNC_EXECUTOR_MAX_THREADS 64
+#endif
 
 namespace adl
 {
+    // Executes every task asynchronously on a set of reusable threads.
+    // Threads are spawned on demand when all existing threads are busy, up to the limit, then tasks wait in the queue.
     class AsyncExecutor
     {
     public:
 
+        AsyncExecutor()
+            : AsyncExecutor(ADL_ASYNC_EXECUTOR_MAX_THREADS)
+        {}
+
+        explicit AsyncExecutor(size_t maxThreads)
+            : m_maxThreads{ std::max<size_t>(maxThreads, 1) }
+        {
+            m_threads.reserve(m_maxThreads);
+        }
+
+        AsyncExecutor(const AsyncExecutor&) = delete;
+        AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+
+        // Pending tasks are executed before threads are stopped
+        ~AsyncExecutor()
+        {
+            {
+                std::unique_lock lock{ m_mutex };
+                m_stopped = true;
+            }
+
+            m_condition.notify_all();
+
+            for (auto&& thread : m_threads)
+            {
+                thread.join();
+            }
+        }
+
         template<typename F>
         void execute(F&& callable)
         {
-            auto&& future = future_execute(std::forward<F>(callable));
-            // future can't be discarded since it will block the thread until the result is ready, so deferring future deletion
-            std::unique_lock lock{ m_mutex };
-            m_futures.emplace_back([sharedFuture = future.share()]() -> bool
-            {
-                return !sharedFuture.valid() || sharedFuture._Is_ready();
-            });
+            push(std::forward<F>(callable));
         }
 
         template<typename... Args>
         void bulk_execute(Args&&... callables)
         {
-            auto futures = std::make_tuple(future_execute(std::forward<Args>(callables))...);
-
-            std::unique_lock lock{ m_mutex };
-            std::apply([this](auto&&... future)
-            {
-                (..., m_futures.emplace_back([sharedFuture = future.share()]() -> bool
-                {
-                    return !sharedFuture.valid() || sharedFuture._Is_ready();
-                }));
-            }, std::move(futures));
+            push(std::forward<Args>(callables)...);
         }
 
 		template<typename F>
 		void defer_execute(F&& callable)
 		{
+			m_stats.on_defer();
 			execute(std::forward<F>(callable));
 		}
 
         template<typename F>
         auto future_execute(F&& callable)
         {
-            return std::async(std::launch::async, std::forward<F>(callable));
+            auto promise = details::make_promise<F>();
+            auto future = details::get_future(promise);
+
+            push(details::make_task(std::move(promise), std::forward<F>(callable)));
+
+            return future;
         }
 
         template<typename... Args>
         auto future_bulk_execute(Args&&... callables)
         {
-            return std::make_tuple(future_execute(std::forward<Args>(callables))...);
+            auto promises = details::make_promises<Args...>();
+            auto futures = details::get_futures(promises);
+            auto tasks = details::make_tasks(std::move(promises), std::forward<Args>(callables)...);
+
+            std::apply([this](auto&&... args) { push(std::forward<decltype(args)>(args)...); }, std::move(tasks));
+
+            return futures;
         }
 
+        // Tasks are dispatched by executor threads, there is nothing to release
         void dispatch()
         {
-            if (!m_futures.empty())
+            [[maybe_unused]] const auto statsScope = m_stats.dispatch_scope();
+        }
+
+        // Number of tasks which are posted and not finished yet
+        size_t active_tasks() const
+        {
+            return m_activeTasks.load(std::memory_order_acquire);
+        }
+
+        ExecutorStats stats() const
+        {
+            return m_stats.snapshot();
+        }
+
+    private:
+
+        using task_t = ExecutionAgent<>;
+
+        template<typename... Args>
+        void push(Args&&... callables)
+        {
+            m_activeTasks.fetch_add(sizeof...(Args), std::memory_order_relaxed);
+            m_stats.on_post(sizeof...(Args));
+
+            std::unique_lock lock{ m_mutex };
+            (..., m_tasks.emplace_back(std::forward<Args>(callables)));
+
+            // Spawn new threads only if there are not enough idle ones to take the queued tasks
+            while (m_tasks.size() > m_idleThreads + m_startingThreads && m_threads.size() < m_maxThreads)
             {
-                std::unique_lock lock{ m_mutex };
-                for (auto it = m_futures.begin(); it != m_futures.end();)
+                ++m_startingThreads;
+                m_threads.emplace_back(&AsyncExecutor::run, this);
+            }
+
+            lock.unlock();
+
+            if constexpr (sizeof...(Args) == 1)
+            {
+                m_condition.notify_one();
+            }
+            else
+            {
+                m_condition.notify_all();
+            }
+        }
+
+        void run()
+        {
+            std::unique_lock lock{ m_mutex };
+            --m_startingThreads;
+
+            while (true)
+            {
+                if (!m_tasks.empty())
                 {
-                    if (std::invoke(*it))
-                    {
-                        it = m_futures.erase(it);
-                    }
-                    else
+                    task_t task = std::move(m_tasks.front());
+                    m_tasks.pop_front();
+                    lock.unlock();
+
                     {
-                        ++it;
+                        [[maybe_unused]] const auto statsScope = m_stats.execute_scope();
+                        task();
+                        task.reset();
                     }
+
+                    m_stats.on_execute(1);
+                    m_activeTasks.fetch_sub(1, std::memory_order_release);
+
+                    lock.lock();
+                }
+                else if (m_stopped)
+                {
+                    break;
+                }
+                else
+                {
+                    ++m_idleThreads;
+                    m_condition.wait(lock, [this] { return m_stopped || !m_tasks.empty(); });
+                    --m_idleThreads;
                 }
             }
         }
 
-    private:
+        const size_t m_maxThreads;
+        std::atomic_size_t m_activeTasks{ 0 };
+        details::executor_stats_t m_stats;
 
         std::mutex m_mutex;
-        std::list<std::function<bool()>> m_futures;
+        std::condition_variable m_condition;
+        details::RingBuffer<task_t> m_tasks;
+        std::vector<std::thread> m_threads;
+        size_t m_idleThreads = 0;
+        size_t m_startingThreads = 0;
+        bool m_stopped = false;
     };
 
 } // namespace adl
\ No newline at end of file
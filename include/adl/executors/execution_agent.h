@@ -0,0 +1,162 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Default size of the inline buffer, with the operations pointer execution agent takes 8 pointers
+#ifndef ADL_EXECUTION_AGENT_INLINE_SIZE
+#define ADL_EXECUTION_AGENT_INLINE_SIZE (7 * sizeof(void*))
+#endif
+
+namespace adl
+{
+	// Move-only type erased execution agent with inline storage.
+	// Callables which fit into the inline buffer and are nothrow move constructible are stored without allocation,
+	// others are allocated on the heap.
+	template<std::size_t InlineSize = ADL_EXECUTION_AGENT_INLINE_SIZE>
+	class ExecutionAgent
+	{
+	public:
+
+		static constexpr std::size_t inline_size = InlineSize;
+
+		// Evaluates to true if callable will be stored in the inline buffer
+		template<typename F>
+		static constexpr bool is_stored_inline_v = sizeof(F) <= InlineSize
+			&& alignof(std::max_align_t) % alignof(F) == 0
+			&& std::is_nothrow_move_constructible_v<F>;
+
+		ExecutionAgent() = default;
+		ExecutionAgent(const ExecutionAgent&) = delete;
+		ExecutionAgent& operator=(const ExecutionAgent&) = delete;
+
+		ExecutionAgent(ExecutionAgent&& other) noexcept
+		{
+			move_from(other);
+		}
+
+		ExecutionAgent& operator=(ExecutionAgent&& other) noexcept
+		{
+			if (this != &other)
+			{
+				reset();
+				move_from(other);
+			}
+
+			return *this;
+		}
+
+		template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, ExecutionAgent>>>
+		ExecutionAgent(F&& callable)
+		{
+			using CallableType = std::decay_t<F>;
+
+			if constexpr (is_stored_inline_v<CallableType>)
+			{
+				new (&m_storage) CallableType(std::forward<F>(callable));
+				m_operations = &InlineOperations<CallableType>::operations;
+			}
+			else
+			{
+				new (&m_storage) CallableType*(new CallableType(std::forward<F>(callable)));
+				m_operations = &HeapOperations<CallableType>::operations;
+			}
+		}
+
+		~ExecutionAgent()
+		{
+			reset();
+		}
+
+		void operator()()
+		{
+			m_operations->invoke(&m_storage);
+		}
+
+		explicit operator bool() const noexcept
+		{
+			return m_operations != nullptr;
+		}
+
+		void reset() noexcept
+		{
+			if (m_operations != nullptr)
+			{
+				m_operations->destroy(&m_storage);
+				m_operations = nullptr;
+			}
+		}
+
+	private:
+
+		struct Operations
+		{
+			void (*invoke)(void* storage);
+			// Move construct callable to the destination storage and destroy the source
+			void (*relocate)(void* destination, void* source) noexcept;
+			void (*destroy)(void* storage) noexcept;
+		};
+
+		template<typename F>
+		struct InlineOperations
+		{
+			static void invoke(void* storage)
+			{
+				std::invoke(*static_cast<F*>(storage));
+			}
+
+			static void relocate(void* destination, void* source) noexcept
+			{
+				new (destination) F(std::move(*static_cast<F*>(source)));
+				static_cast<F*>(source)->~F();
+			}
+
+			static void destroy(void* storage) noexcept
+			{
+				static_cast<F*>(storage)->~F();
+			}
+
+			static constexpr Operations operations{ &invoke, &relocate, &destroy };
+		};
+
+		template<typename F>
+		struct HeapOperations
+		{
+			static void invoke(void* storage)
+			{
+				std::invoke(**static_cast<F**>(storage));
+			}
+
+			static void relocate(void* destination, void* source) noexcept
+			{
+				new (destination) F*(*static_cast<F**>(source));
+			}
+
+			static void destroy(void* storage) noexcept
+			{
+				delete *static_cast<F**>(storage);
+			}
+
+			static constexpr Operations operations{ &invoke, &relocate, &destroy };
+		};
+
+		void move_from(ExecutionAgent& other) noexcept
+		{
+			if (other.m_operations != nullptr)
+			{
+				other.m_operations->relocate(&m_storage, &other.m_storage);
+				m_operations = std::exchange(other.m_operations, nullptr);
+			}
+		}
+
+		static_assert(InlineSize >= sizeof(void*), "Inline buffer should be able to hold a pointer to the heap allocated callable");
+
+		alignas(std::max_align_t) unsigned char m_storage[InlineSize];
+		const Operations* m_operations = nullptr;
+	};
+}
\ No newline at end of file
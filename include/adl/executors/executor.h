@@ -2,8 +2,9 @@
 // MIT License | https://opensource.org/licenses/MIT
 
 #pragma once
-#include <future>
-#include <memory>
+#include "../future.h"
+#include <functional>
+#include <tuple>
 
 namespace adl
 {
@@ -12,10 +13,9 @@ namespace adl
 		template<typename F>
 		static auto make_promise()
 		{
-			// Future task captures the promise and then stored inside the std::function,
-			// but there exists a fundamental requirement, that the wrapped functor should be copy-constructible to perform type erasure.
-			// so we can't use raw std::promise as it is movable only, that's why shared_ptr is used.
-			return std::make_shared<std::promise<std::invoke_result_t<F>>>();
+			// Future task captures the promise and then stored inside the move-only ExecutionAgent,
+			// so unlike std::function the promise can be captured directly without the shared_ptr.
+			return promise<std::invoke_result_t<F>>{};
 		}
 
 		template<typename... Args>
@@ -25,9 +25,9 @@ namespace adl
 		}
 
 		template<typename T>
-		static auto get_future(std::shared_ptr<std::promise<T>>& promise)
+		static auto get_future(promise<T>& promise)
 		{
-			return promise->get_future();
+			return promise.get_future();
 		}
 
 		template<typename T>
@@ -37,21 +37,21 @@ namespace adl
 		}
 
 		template<typename T, typename F>
-		static auto make_task(std::shared_ptr<std::promise<T>>&& promise, F&& callable)
+		static auto make_task(promise<T>&& promise, F&& callable)
 		{
 			if constexpr (std::is_void_v<std::invoke_result_t<F>>)
 			{
-				return[promise = std::move(promise), callable = std::forward<F>(callable)]()
+				return[promise = std::move(promise), callable = std::forward<F>(callable)]() mutable
 				{
 					std::invoke(callable);
-					promise->set_value();
+					promise.set_value();
 				};
 			}
 			else
 			{
-				return[promise = std::move(promise), callable = std::forward<F>(callable)]()
+				return[promise = std::move(promise), callable = std::forward<F>(callable)]() mutable
 				{
-					promise->set_value(std::invoke(callable));
+					promise.set_value(std::invoke(callable));
 				};
 			}
 		}
@@ -0,0 +1,156 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+// Enables executor statistics, disabled counters are empty and cost nothing
+#ifndef ADL_EXECUTOR_STATS
+#define ADL_EXECUTOR_STATS 0
+#endif
+
+namespace adl
+{
+	// Snapshot of the executor counters, all values are zero if statistics are disabled
+	struct ExecutorStats
+	{
+		size_t posted = 0;
+		size_t executed = 0;
+		size_t deferred = 0;
+		// Tasks which are posted and not executed yet
+		size_t queue_depth = 0;
+		size_t max_queue_depth = 0;
+		size_t dispatches = 0;
+		// Time spent executing tasks inside of dispatch() or by executor threads
+		std::chrono::nanoseconds dispatch_time{ 0 };
+	};
+
+	namespace details
+	{
+		// Executor counters, relaxed atomics are used so enabled statistics don't add synchronization between threads
+		class ExecutorStatsCounters
+		{
+		public:
+
+			// Measures time until destroyed
+			class Scope
+			{
+			public:
+
+				Scope(ExecutorStatsCounters& counters, bool dispatch)
+					: m_counters{ counters }
+					, m_dispatch{ dispatch }
+					, m_start{ std::chrono::steady_clock::now() }
+				{}
+
+				Scope(const Scope&) = delete;
+				Scope& operator=(const Scope&) = delete;
+
+				~Scope()
+				{
+					m_counters.on_time(std::chrono::steady_clock::now() - m_start, m_dispatch);
+				}
+
+			private:
+
+				ExecutorStatsCounters& m_counters;
+				const bool m_dispatch;
+				const std::chrono::steady_clock::time_point m_start;
+			};
+
+			void on_post(size_t count)
+			{
+				const size_t posted = m_posted.fetch_add(count, std::memory_order_relaxed) + count;
+				const size_t depth = posted - std::min(posted, m_executed.load(std::memory_order_relaxed));
+
+				size_t maxDepth = m_maxQueueDepth.load(std::memory_order_relaxed);
+
+				while (depth > maxDepth && !m_maxQueueDepth.compare_exchange_weak(maxDepth, depth, std::memory_order_relaxed))
+				{}
+			}
+
+			// Deferred task is counted as posted too
+			void on_defer()
+			{
+				m_deferred.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			void on_execute(size_t count)
+			{
+				m_executed.fetch_add(count, std::memory_order_relaxed);
+			}
+
+			// Counts dispatch call and its time
+			Scope dispatch_scope()
+			{
+				return Scope{ *this, true };
+			}
+
+			// Counts time of the tasks executed outside of dispatch call
+			Scope execute_scope()
+			{
+				return Scope{ *this, false };
+			}
+
+			ExecutorStats snapshot() const
+			{
+				ExecutorStats stats;
+				stats.executed = m_executed.load(std::memory_order_relaxed);
+				stats.posted = m_posted.load(std::memory_order_relaxed);
+				stats.deferred = m_deferred.load(std::memory_order_relaxed);
+				stats.queue_depth = stats.posted - std::min(stats.posted, stats.executed);
+				stats.max_queue_depth = m_maxQueueDepth.load(std::memory_order_relaxed);
+				stats.dispatches = m_dispatches.load(std::memory_order_relaxed);
+				stats.dispatch_time = std::chrono::nanoseconds{ m_dispatchTime.load(std::memory_order_relaxed) };
+				return stats;
+			}
+
+		private:
+
+			void on_time(std::chrono::steady_clock::duration time, bool dispatch)
+			{
+				if (dispatch)
+				{
+					m_dispatches.fetch_add(1, std::memory_order_relaxed);
+				}
+
+				m_dispatchTime.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(time).count(), std::memory_order_relaxed);
+			}
+
+			// Producers and consumers update different cache lines
+			alignas(64) std::atomic_size_t m_posted{ 0 };
+			std::atomic_size_t m_deferred{ 0 };
+			std::atomic_size_t m_maxQueueDepth{ 0 };
+			alignas(64) std::atomic_size_t m_executed{ 0 };
+			std::atomic_size_t m_dispatches{ 0 };
+			std::atomic<std::chrono::nanoseconds::rep> m_dispatchTime{ 0 };
+		};
+
+		// Counters used when statistics are disabled
+		class NoExecutorStatsCounters
+		{
+		public:
+
+			struct Scope
+			{};
+
+			void on_post(size_t) {}
+			void on_defer() {}
+			void on_execute(size_t) {}
+
+			Scope dispatch_scope() { return {}; }
+			Scope execute_scope() { return {}; }
+
+			ExecutorStats snapshot() const { return {}; }
+		};
+
+		#if ADL_EXECUTOR_STATS
+		using executor_stats_t = ExecutorStatsCounters;
+		#else
+		using executor_stats_t = NoExecutorStatsCounters;
+		#endif
+	}
+}
\ No newline at end of file
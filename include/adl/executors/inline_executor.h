@@ -2,9 +2,11 @@
 // MIT License | https://opensource.org/licenses/MIT
 
 #pragma once
+#include "../future.h"
+#include "executor_stats.h"
+#include <functional>
 #include <type_traits>
 #include <tuple>
-#include <future>
 
 namespace adl {
 
@@ -15,27 +17,35 @@ public:
     template<typename F>
     inline constexpr void execute(F&& callable)
     {
+		m_stats.on_post(1);
 		callable();
+		m_stats.on_execute(1);
     }
 
     template<typename... Args>
     inline constexpr void bulk_execute(Args&&... callables)
     {
+		m_stats.on_post(sizeof...(Args));
         (..., std::forward<Args>(callables)());
+		m_stats.on_execute(sizeof...(Args));
     }
 
 	template<typename F>
 	inline constexpr void defer_execute(F&& callable)
 	{
 		// Be careful, deferring tasks for inline executor is a recursion!
-		callable();
+		m_stats.on_defer();
+		execute(std::forward<F>(callable));
 	}	
 
     template<typename F>
     inline auto future_execute(F&& callable)
     {
-		//#TODO: C++2x return std::make_ready_future(...);
-		return make_ready_future(std::forward<F>(callable));
+		m_stats.on_post(1);
+		auto future = make_ready_future(std::forward<F>(callable));
+		m_stats.on_execute(1);
+
+		return future;
     }
 
     template<typename... Args>
@@ -44,25 +54,35 @@ public:
 		return std::make_tuple(future_execute(std::forward<Args>(callables))...);
     }
 
+	// Tasks are executed right away, there is nothing to dispatch
+	void dispatch()
+	{
+		[[maybe_unused]] const auto statsScope = m_stats.dispatch_scope();
+	}
+
+	ExecutorStats stats() const
+	{
+		return m_stats.snapshot();
+	}
+
 private:
 
+	// Result is stored inside the future, no shared state is allocated
 	template<typename F>
 	static constexpr auto make_ready_future(F&& callable)
-	{		
-		std::promise<std::invoke_result_t<F>> promise;
-
+	{
 		if constexpr (std::is_void_v<std::invoke_result_t<F>>)
 		{
 			std::invoke(std::forward<F>(callable));
-			promise.set_value();
+			return adl::make_ready_future();
 		}
 		else
 		{
-			promise.set_value(std::invoke(std::forward<F>(callable)));
+			return adl::make_ready_future(std::invoke(std::forward<F>(callable)));
 		}
-
-		return promise.get_future();
 	}
+
+	details::executor_stats_t m_stats;
 };
 
 } // namespace adl {
\ No newline at end of file
@@ -0,0 +1,260 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include "../priority.h"
+#include "executor.h"
+#include "execution_agent.h"
+#include "executor_stats.h"
+#include "run_loop.h"
+#include "task_queue.h"
+#include <array>
+#include <chrono>
+#include <functional>
+
+namespace adl {
+
+	// Queue executor with a queue per priority level, tasks of the highest non-empty level are dispatched first
+	// and FIFO order is kept within the level. Tasks posted without priority inherit the priority of the running task.
+	template<typename TaskQueueType>
+	class BasicPriorityQueueExecutor
+	{
+	public:
+
+		template<typename F>
+		void execute(F&& callable)
+		{
+			execute(details::current_priority(), std::forward<F>(callable));
+		}
+
+		template<typename F>
+		void execute(Priority priority, F&& callable)
+		{
+			m_stats.on_post(1);
+			level(priority).tasks.emplace(std::forward<F>(callable));
+			notify();
+		}
+
+		template<typename... Args>
+		void bulk_execute(Args&&... callables)
+		{
+			m_stats.on_post(sizeof...(Args));
+			level(details::current_priority()).tasks.emplace_bulk(std::forward<Args>(callables)...);
+			notify();
+		}
+
+		template<typename F>
+		void defer_execute(F&& callable)
+		{
+			m_stats.on_defer();
+			m_stats.on_post(1);
+			level(details::current_priority()).deferredTasks.emplace(std::forward<F>(callable));
+			notify();
+		}
+
+		template<typename F>
+		auto future_execute(F&& callable)
+		{
+			return future_execute(details::current_priority(), std::forward<F>(callable));
+		}
+
+		template<typename F>
+		auto future_execute(Priority priority, F&& callable)
+		{
+			auto promise = details::make_promise<F>();
+			auto future = details::get_future(promise);
+			auto task = details::make_task(std::move(promise), std::forward<F>(callable));
+
+			m_stats.on_post(1);
+			level(priority).tasks.emplace(std::move(task));
+			notify();
+
+			return future;
+		}
+
+		template<typename... Args>
+		auto future_bulk_execute(Args&&... callables)
+		{
+			auto promises = details::make_promises<Args...>();
+			auto futures = details::get_futures(promises);
+			auto tasks = details::make_tasks(std::move(promises), std::forward<Args>(callables)...);
+
+			m_stats.on_post(sizeof...(Args));
+			std::apply([this](auto&&... args) { level(details::current_priority()).tasks.emplace_bulk(std::forward<decltype(args)>(args)...); }, std::move(tasks));
+			notify();
+
+			return futures;
+		}
+
+		// Should be called from one thread at a time
+		void dispatch()
+		{
+			dispatch_while([] { return true; });
+		}
+
+		// Dispatch tasks until the time budget is spent, returns the number of tasks which remain in the queues
+		template<typename Rep, typename Period>
+		size_t dispatch_for(std::chrono::duration<Rep, Period> duration)
+		{
+			const auto deadline = std::chrono::steady_clock::now() + duration;
+			return dispatch_while([deadline] { return std::chrono::steady_clock::now() < deadline; });
+		}
+
+		// Dispatch at most count tasks, returns the number of tasks which remain in the queues
+		size_t dispatch_n(size_t count)
+		{
+			return dispatch_while([&count] { return count-- > 0; });
+		}
+
+		// Dispatch tasks until the stop is requested, the thread is parked while the queues are empty
+		void run_until(const stop_token& token, size_t spins = ADL_RUN_SPIN_COUNT)
+		{
+			details::run_loop(m_event, token, spins, [this] { dispatch(); }, [this] { return has_tasks(); });
+		}
+
+		// Checked without locks, should be called from the dispatching thread
+		bool has_tasks() const
+		{
+			for (const Level& level : m_levels)
+			{
+				if (!level.batch.empty() || !level.tasks.empty() || !level.deferredTasks.empty())
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		// Forward wakeups to the event shared by several executors, nullptr stops forwarding
+		void set_shared_event(details::EventCount* event)
+		{
+			m_event.set_shared(event);
+		}
+
+		// Dispatch tasks until stop() is called
+		void run(size_t spins = ADL_RUN_SPIN_COUNT)
+		{
+			run_until(m_stopSource.get_token(), spins);
+		}
+
+		// Return from all run() calls, subsequent calls return immediately
+		void stop()
+		{
+			m_stopSource.request_stop();
+		}
+
+		ExecutorStats stats() const
+		{
+			return m_stats.snapshot();
+		}
+
+	private:
+
+		using task_queue_t = TaskQueueType;
+		using batch_t = typename task_queue_t::batch_t;
+
+		// Nobody can be parked on the single-thread queues while a task is posted to them
+		void notify()
+		{
+			if constexpr (task_queue_t::is_concurrent)
+			{
+				m_event.notify();
+			}
+		}
+
+		struct Level
+		{
+			task_queue_t tasks;
+			task_queue_t deferredTasks;
+			batch_t batch;
+		};
+
+		Level& level(Priority priority)
+		{
+			return m_levels[static_cast<size_t>(priority)];
+		}
+
+		// Higher levels are checked before every task, so posted urgent tasks don't wait for the rest of the batch
+		template<typename Predicate>
+		size_t dispatch_while(Predicate&& predicate)
+		{
+			[[maybe_unused]] const auto statsScope = m_stats.dispatch_scope();
+
+			while (predicate())
+			{
+				Level* next = nullptr;
+
+				for (size_t i = PRIORITY_LEVELS; i-- > 0 && next == nullptr; )
+				{
+					Level& level = m_levels[i];
+
+					// Queue is refilled only when the local batch is exhausted, empty queues aren't touched
+					if (level.batch.empty() && !level.tasks.empty())
+					{
+						level.tasks.pop_all(level.batch);
+					}
+
+					if (!level.batch.empty())
+					{
+						next = &level;
+					}
+				}
+
+				if (next == nullptr)
+				{
+					break;
+				}
+
+				auto task = std::move(next->batch.front());
+				next->batch.pop_front();
+
+				{
+					details::PriorityScope priorityScope{ static_cast<Priority>(next - m_levels.data()) };
+					std::invoke(task);
+				}
+
+				m_stats.on_execute(1);
+			}
+
+			size_t remaining = 0;
+
+			// Pending tasks go before deferred ones of the same level, so the order doesn't depend on the budget
+			for (Level& level : m_levels)
+			{
+				if (!level.tasks.empty())
+				{
+					level.tasks.pop_all(level.batch);
+				}
+
+				if (!level.deferredTasks.empty())
+				{
+					level.deferredTasks.pop_all(level.batch);
+				}
+
+				remaining += level.batch.size();
+			}
+
+			return remaining;
+		}
+
+		std::array<Level, PRIORITY_LEVELS> m_levels;
+		details::EventCount m_event;
+		stop_source m_stopSource;
+		details::executor_stats_t m_stats;
+	};
+
+	// Priority executor with lock-free multi-producer/single-consumer queue per level, dispatch() should be called from one thread only
+	using PriorityQueueExecutor = BasicPriorityQueueExecutor<details::MPSCTaskQueue<ExecutionAgent<>>>;
+
+	namespace details
+	{
+		// Queues of the executor are picked by the concurrency of the channel
+		template<typename TaskQueueType, Concurrency ConcurrencyType>
+		struct concurrent_executor<BasicPriorityQueueExecutor<TaskQueueType>, ConcurrencyType>
+		{
+			using type = BasicPriorityQueueExecutor<concurrent_task_queue_t<ConcurrencyType, TaskQueueType>>;
+		};
+	}
+
+}
\ No newline at end of file
@@ -4,36 +4,52 @@
 
 #pragma once
 #include "executor.h"
+#include "execution_agent.h"
+#include "executor_stats.h"
+#include "run_loop.h"
+#include "task_arena.h"
+#include "task_queue.h"
+#include <chrono>
 #include <functional>
-#include <queue>
-#include <mutex>
 #include <future>
+#include <type_traits>
 
 namespace adl {
 
-class QueueExecutor
+template<typename TaskQueueType>
+class BasicQueueExecutor
 {
 public:
 
     template<typename F>
     void execute(F&& callable)
     {
-        std::unique_lock lock{ m_tasksMutex };
+        static_assert(is_storable_v<F>, "Callable can't be stored by the task queue of the executor");
+
+        m_stats.on_post(1);
         m_tasks.emplace(std::forward<F>(callable));
+        notify();
     }
 
 	template<typename... Args>
 	void bulk_execute(Args&&... callables)
 	{
-		std::unique_lock lock{ m_tasksMutex };
-        (..., m_tasks.emplace(std::forward<Args>(callables)));
+        static_assert((... && is_storable_v<Args>), "Callable can't be stored by the task queue of the executor");
+
+        m_stats.on_post(sizeof...(Args));
+        m_tasks.emplace_bulk(std::forward<Args>(callables)...);
+        notify();
     }
 
 	template<typename F>
 	void defer_execute(F&& callable)
 	{
-		std::unique_lock lock{ m_deferredTasksMutex };
+		static_assert(is_storable_v<F>, "Callable can't be stored by the task queue of the executor");
+
+		m_stats.on_defer();
+		m_stats.on_post(1);
 		m_deferredTasks.emplace(std::forward<F>(callable));
+		notify();
 	}
 
     template<typename F>
@@ -43,12 +59,13 @@ public:
 		auto future = details::get_future(promise);
 		auto task = details::make_task(std::move(promise), std::forward<F>(callable));
 
-		{
-			std::unique_lock lock{ m_tasksMutex };
-			m_tasks.emplace(std::move(task));
-		}
+		static_assert(is_storable_v<decltype(task)>, "Futures are not supported by the task queue of the executor");
+
+		m_stats.on_post(1);
+		m_tasks.emplace(std::move(task));
+		notify();
 
-		return std::move(future);
+		return future;
     }
 
     template<typename... Args>
@@ -58,40 +75,146 @@ public:
 		auto futures = details::get_futures(promises);
 		auto tasks = details::make_tasks(std::move(promises), std::forward<Args>(callables)...);
 
-		{
-			std::unique_lock lock{ m_tasksMutex };
-			std::apply([this](auto&&... args) { (..., m_tasks.emplace(std::forward<decltype(args)>(args))); }, std::move(tasks));
-		}
+		m_stats.on_post(sizeof...(Args));
+		std::apply([this](auto&&... args) { m_tasks.emplace_bulk(std::forward<decltype(args)>(args)...); }, std::move(tasks));
+		notify();
 
-		return std::move(futures);
+		return futures;
     }
 
+    // Should be called from one thread at a time
     void dispatch()
-    {   
-        while (!m_tasks.empty())
-        {
-            std::unique_lock lock{ m_tasksMutex };
-            auto task = std::move(m_tasks.front());
-            m_tasks.pop();
-            lock.unlock();
+    {
+        dispatch_while([] { return true; });
+    }
 
-            std::invoke(task);
-        }
+    // Dispatch tasks until the time budget is spent, the rest of tasks are left in order for the next call.
+    // Returns the number of tasks which remain in the queue.
+    template<typename Rep, typename Period>
+    size_t dispatch_for(std::chrono::duration<Rep, Period> duration)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + duration;
+        return dispatch_while([deadline] { return std::chrono::steady_clock::now() < deadline; });
+    }
 
-		std::scoped_lock lock{ m_deferredTasksMutex, m_tasksMutex };
-		while (!m_deferredTasks.empty())
-		{
-			m_tasks.emplace(std::move(m_deferredTasks.front()));
-			m_deferredTasks.pop();
-		}
+    // Dispatch at most count tasks, the rest of tasks are left in order for the next call.
+    // Returns the number of tasks which remain in the queue.
+    size_t dispatch_n(size_t count)
+    {
+        return dispatch_while([&count] { return count-- > 0; });
+    }
+
+    // Dispatch tasks until the stop is requested, the thread is parked while the queue is empty and woken by posted tasks.
+    // Spins before parking if spins are provided. Should be called from one thread at a time.
+    void run_until(const stop_token& token, size_t spins = ADL_RUN_SPIN_COUNT)
+    {
+        details::run_loop(m_event, token, spins, [this] { dispatch(); }, [this] { return has_tasks(); });
+    }
+
+    // Checked without locks, should be called from the dispatching thread
+    bool has_tasks() const
+    {
+        return !m_batch.empty() || !m_tasks.empty() || !m_deferredTasks.empty();
+    }
+
+    // Forward wakeups to the event shared by several executors, nullptr stops forwarding
+    void set_shared_event(details::EventCount* event)
+    {
+        m_event.set_shared(event);
+    }
+
+    // Dispatch tasks until stop() is called
+    void run(size_t spins = ADL_RUN_SPIN_COUNT)
+    {
+        run_until(m_stopSource.get_token(), spins);
+    }
+
+    // Return from all run() calls, subsequent calls return immediately
+    void stop()
+    {
+        m_stopSource.request_stop();
+    }
+
+    ExecutorStats stats() const
+    {
+        return m_stats.snapshot();
     }
 
 private:
 
-    std::mutex m_tasksMutex;
-	std::mutex m_deferredTasksMutex;
-    std::queue<std::function<void()>> m_tasks;
-	std::queue<std::function<void()>> m_deferredTasks;
+    using task_queue_t = TaskQueueType;
+    using batch_t = typename task_queue_t::batch_t;
+
+    // Typed queues store tasks of a single type, other callables are rejected at compile time
+    template<typename F>
+    static constexpr bool is_storable_v = details::is_storable_v<TaskQueueType, F&&>;
+
+    // Nobody can be parked on the single-thread queue while a task is posted to it
+    void notify()
+    {
+        if constexpr (task_queue_t::is_concurrent)
+        {
+            m_event.notify();
+        }
+    }
+
+    // Predicate is checked before every task
+    template<typename Predicate>
+    size_t dispatch_while(Predicate&& predicate)
+    {
+        [[maybe_unused]] const auto statsScope = m_stats.dispatch_scope();
+
+        // Take all pending tasks at once, tasks posted during the dispatch are taken when the batch is over
+        for (m_tasks.pop_all(m_batch); !m_batch.empty() && predicate(); )
+        {
+            details::invoke_front(m_batch);
+            m_stats.on_execute(1);
+
+            if (m_batch.empty())
+            {
+                m_tasks.pop_all(m_batch);
+            }
+        }
+
+        // Pending tasks are moved to the batch as well, so the remaining tasks can be counted.
+        // Deferred tasks go after them, so the order doesn't depend on the budget.
+        m_tasks.pop_all(m_batch);
+        m_deferredTasks.pop_all(m_batch);
+
+        return m_batch.size();
+    }
+
+    task_queue_t m_tasks;
+    task_queue_t m_deferredTasks;
+    batch_t m_batch;
+    details::EventCount m_event;
+    stop_source m_stopSource;
+    details::executor_stats_t m_stats;
 };
 
+// Queue executor which guards tasks with a mutex
+using QueueExecutor = BasicQueueExecutor<details::LockedTaskQueue<ExecutionAgent<>>>;
+
+// Queue executor with lock-free multi-producer/single-consumer queue, dispatch() should be called from one thread only
+using LockFreeQueueExecutor = BasicQueueExecutor<details::MPSCTaskQueue<ExecutionAgent<>>>;
+
+// Queue executor which stores tasks of a single type by value in a contiguous ring guarded by a mutex.
+// Tasks are invoked without type erasure, so the dispatch loop is inlined. Other callables and futures can't be posted.
+template<typename F>
+using TypedQueueExecutor = BasicQueueExecutor<details::LockedTaskQueue<F, details::RingBuffer<F>>>;
+
+// Queue executor which places tasks of any types into a chunked arena, so they are packed densely and not allocated one by one.
+// Tasks are invoked in place by a linear scan, drained chunks are reused by the following posts.
+using ArenaQueueExecutor = BasicQueueExecutor<details::ArenaTaskQueue<>>;
+
+namespace details
+{
+    // Queue of the executor is picked by the concurrency of the channel
+    template<typename TaskQueueType, Concurrency ConcurrencyType>
+    struct concurrent_executor<BasicQueueExecutor<TaskQueueType>, ConcurrencyType>
+    {
+        using type = BasicQueueExecutor<concurrent_task_queue_t<ConcurrencyType, TaskQueueType>>;
+    };
+}
+
 }
\ No newline at end of file
@@ -0,0 +1,112 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include "../atomic_wait.h"
+#include "../stop_token.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Number of spins before the run loop parks the thread, spinning is disabled by default
+#ifndef ADL_RUN_SPIN_COUNT
+#define ADL_RUN_SPIN_COUNT 0
+#endif
+
+namespace adl
+{
+	namespace details
+	{
+		// Wakes threads parked until there is new work. Notify doesn't make a syscall unless a thread is parked,
+		// waiter announces itself before the last check for work, so a notification can't be missed.
+		class EventCount
+		{
+		public:
+
+			// Returns the epoch which should be passed to wait, work should be checked once more after this call
+			uint32_t prepare_wait()
+			{
+				m_waiters.fetch_add(1, std::memory_order_seq_cst);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				return m_epoch.load(std::memory_order_acquire);
+			}
+
+			// Work has been found after prepare_wait
+			void cancel_wait()
+			{
+				m_waiters.fetch_sub(1, std::memory_order_relaxed);
+			}
+
+			// Park the thread until notified after prepare_wait
+			void wait(uint32_t epoch)
+			{
+				while (m_epoch.load(std::memory_order_acquire) == epoch)
+				{
+					atomic_wait(m_epoch, epoch);
+				}
+
+				m_waiters.fetch_sub(1, std::memory_order_relaxed);
+			}
+
+			// Should be called after the work is published
+			void notify()
+			{
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+
+				if (m_waiters.load(std::memory_order_relaxed) != 0)
+				{
+					m_epoch.fetch_add(1, std::memory_order_release);
+					atomic_notify_all(m_epoch);
+				}
+
+				if (EventCount* shared = m_shared.load(std::memory_order_relaxed))
+				{
+					shared->notify();
+				}
+			}
+
+			// Forward notifications to the shared event, so a thread can park until any of several executors has work.
+			// Shared event should have static storage duration, a notification can reach it after it's unset.
+			// It's set before the waiter checks for work, so the fences of prepare_wait and notify order them.
+			void set_shared(EventCount* shared)
+			{
+				m_shared.store(shared, std::memory_order_seq_cst);
+			}
+
+		private:
+
+			std::atomic<uint32_t> m_epoch{ 0 };
+			std::atomic<uint32_t> m_waiters{ 0 };
+			std::atomic<EventCount*> m_shared{ nullptr };
+		};
+
+		// Dispatch until the stop is requested, the thread spins and then parks on the event while there is no work
+		template<typename DispatchType, typename HasWorkType>
+		void run_loop(EventCount& event, const stop_token& token, size_t spins, DispatchType&& dispatch, HasWorkType&& hasWork)
+		{
+			stop_callback wakeOnStop{ token, [&event] { event.notify(); } };
+
+			const auto ready = [&] { return hasWork() || token.stop_requested(); };
+
+			while (!token.stop_requested())
+			{
+				dispatch();
+
+				if (spin_until(ready, spins))
+				{
+					continue;
+				}
+
+				const uint32_t epoch = event.prepare_wait();
+
+				if (ready())
+				{
+					event.cancel_wait();
+					continue;
+				}
+
+				event.wait(epoch);
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -3,6 +3,10 @@
 
 #pragma once
 #include "executor.h"
+#include "execution_agent.h"
+#include "executor_stats.h"
+#include "run_loop.h"
+#include <atomic>
 #include <functional>
 #include <vector>
 #include <mutex>
@@ -17,21 +21,34 @@ namespace adl {
 		template<typename F>
 		void execute(F&& callable)
 		{
-			std::unique_lock lock{ m_mutex };
-			m_tasks.emplace_back(std::forward<F>(callable));
+			m_stats.on_post(1);
+			{
+				std::unique_lock lock{ m_mutex };
+				m_tasks.emplace_back(std::forward<F>(callable));
+				m_pending.store(true, std::memory_order_relaxed);
+			}
+
+			m_event.notify();
 		}
 
 		template<typename... Args>
 		void bulk_execute(Args&&... callables)
 		{
-			std::unique_lock lock{ m_mutex };
-			(..., m_tasks.emplace_back(std::forward<Args>(callables)));
+			m_stats.on_post(sizeof...(Args));
+			{
+				std::unique_lock lock{ m_mutex };
+				(..., m_tasks.emplace_back(std::forward<Args>(callables)));
+				m_pending.store(true, std::memory_order_relaxed);
+			}
+
+			m_event.notify();
 		}
 
 		template<typename F>
 		void defer_execute(F&& callable)
 		{
 			// All executions in strand are deferred
+			m_stats.on_defer();
 			execute(std::forward<F>(callable));
 		}
 
@@ -42,11 +59,15 @@ namespace adl {
 			auto future = details::get_future(promise);
 			auto task = details::make_task(std::move(promise), std::forward<F>(callable));
 
+			m_stats.on_post(1);
+
 			{
 				std::unique_lock lock{ m_mutex };
 				m_tasks.emplace_back(std::move(task));
+				m_pending.store(true, std::memory_order_relaxed);
 			}
 
+			m_event.notify();
 			return std::move(future);
 		}
 
@@ -57,34 +78,96 @@ namespace adl {
 			auto futures = details::get_futures(promises);
 			auto tasks = details::make_tasks(std::move(promises), std::forward<Args>(callables)...);
 
+			m_stats.on_post(sizeof...(Args));
+
 			{
 				std::unique_lock lock{ m_mutex };
 				std::apply([this](auto&&... args) { (..., m_tasks.emplace_back(std::forward<decltype(args)>(args))); }, std::move(tasks));
+				m_pending.store(true, std::memory_order_relaxed);
 			}
 
+			m_event.notify();
 			return std::move(futures);
 		}
 
 		void dispatch()
 		{
-			if (!m_tasks.empty())
+			[[maybe_unused]] const auto statsScope = m_stats.dispatch_scope();
+
+			// Tasks are iterated in a local batch, so a task can dispatch the strand again.
+			// Spare buffer is swapped with the pending tasks, so its capacity is reused and tasks don't allocate once warmed up.
+			std::vector<ExecutionAgent<>> batch = std::move(m_batch);
+
 			{
 				std::unique_lock lock{ m_mutex };
-				auto tasks = std::move(m_tasks);
-				m_tasks.clear();
-				lock.unlock();
 
-				for (auto&& task : tasks)
+				if (m_tasks.empty())
 				{
-					task();
+					m_batch = std::move(batch);
+					return;
 				}
+
+				m_tasks.swap(batch);
+				m_pending.store(false, std::memory_order_relaxed);
 			}
+
+			for (auto&& task : batch)
+			{
+				task();
+			}
+
+			m_stats.on_execute(batch.size());
+
+			batch.clear();
+			m_batch = std::move(batch);
+		}
+
+		// Dispatch tasks until the stop is requested, the thread is parked while there are no tasks and woken by posted tasks.
+		// Spins before parking if spins are provided.
+		void run_until(const stop_token& token, size_t spins = ADL_RUN_SPIN_COUNT)
+		{
+			details::run_loop(m_event, token, spins, [this] { dispatch(); }, [this] { return has_tasks(); });
+		}
+
+		// Checked without the lock, tasks are taken under the lock anyway
+		bool has_tasks() const
+		{
+			return m_pending.load(std::memory_order_relaxed);
+		}
+
+		// Forward wakeups to the event shared by several executors, nullptr stops forwarding
+		void set_shared_event(details::EventCount* event)
+		{
+			m_event.set_shared(event);
+		}
+
+		// Dispatch tasks until stop() is called
+		void run(size_t spins = ADL_RUN_SPIN_COUNT)
+		{
+			run_until(m_stopSource.get_token(), spins);
+		}
+
+		// Return from all run() calls, subsequent calls return immediately
+		void stop()
+		{
+			m_stopSource.request_stop();
+		}
+
+		ExecutorStats stats() const
+		{
+			return m_stats.snapshot();
 		}
 
 	private:
 
 		std::mutex m_mutex;
-		std::vector<std::function<void()>> m_tasks;
+		std::vector<ExecutionAgent<>> m_tasks;
+		// Spare buffer of the dispatch
+		std::vector<ExecutionAgent<>> m_batch;
+		std::atomic_bool m_pending{ false };
+		details::EventCount m_event;
+		stop_source m_stopSource;
+		details::executor_stats_t m_stats;
 	};
 
 }
\ No newline at end of file
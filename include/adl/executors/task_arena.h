@@ -0,0 +1,469 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include "task_queue.h"
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Size of the arena chunk in bytes, callables which don't fit into an empty chunk are allocated on the heap
+#ifndef ADL_TASK_ARENA_CHUNK_SIZE
+#define ADL_TASK_ARENA_CHUNK_SIZE 16384
+#endif
+
+// Number of drained chunks kept by the task queue for reuse, the others are released
+#ifndef ADL_TASK_ARENA_SPARE_CHUNKS
+#define ADL_TASK_ARENA_SPARE_CHUNKS 16
+#endif
+
+namespace adl
+{
+	namespace details
+	{
+		enum class ArenaOperation
+		{
+			Invoke,
+			Destroy,
+		};
+
+		class TaskArena;
+
+		// Consumes the record of the arena, then invokes and destroys its callable or only destroys it
+		using ArenaThunk = void (*)(TaskArena& arena, unsigned char* record, ArenaOperation operation);
+
+		struct ArenaChunk
+		{
+			static constexpr std::size_t CAPACITY = ADL_TASK_ARENA_CHUNK_SIZE;
+
+			ArenaChunk* next = nullptr;
+			std::size_t used = 0;
+			alignas(std::max_align_t) unsigned char bytes[CAPACITY];
+		};
+
+		// FIFO of callables of any types placed into a chain of chunks. Every record is a thunk word followed by the callable,
+		// the gap before an over-aligned callable is filled with empty words. Records are invoked in place by a linear scan
+		// and drained chunks are kept for reuse.
+		class TaskArena
+		{
+		public:
+
+			// Evaluates to true if callable is placed into the chunk, others are allocated on the heap and the record keeps the pointer
+			template<typename F>
+			static constexpr bool is_stored_inline_v = alignof(F) <= alignof(std::max_align_t)
+				&& sizeof(ArenaThunk) + sizeof(F) + alignof(F) <= ArenaChunk::CAPACITY;
+
+			TaskArena() = default;
+			TaskArena(const TaskArena&) = delete;
+			TaskArena& operator=(const TaskArena&) = delete;
+
+			~TaskArena()
+			{
+				clear();
+
+				release(m_head);
+				release(m_spare);
+			}
+
+			bool empty() const { return m_size == 0; }
+
+			std::size_t size() const { return m_size; }
+
+			template<typename F>
+			void emplace_back(F&& callable)
+			{
+				using CallableType = std::decay_t<F>;
+
+				if constexpr (is_stored_inline_v<CallableType>)
+				{
+					unsigned char* record = reserve(alignof(CallableType), record_size<CallableType>());
+
+					write_thunk(record, &inline_thunk<CallableType>);
+					new (record + sizeof(ArenaThunk)) CallableType(std::forward<F>(callable));
+				}
+				else
+				{
+					unsigned char* record = reserve(alignof(CallableType*), record_size<CallableType*>());
+
+					write_thunk(record, &heap_thunk<CallableType>);
+					new (record + sizeof(ArenaThunk)) CallableType*(new CallableType(std::forward<F>(callable)));
+				}
+
+				++m_size;
+			}
+
+			// Invoke and destroy the first callable. Tasks posted by it should go to another arena and it shouldn't invoke
+			// the callables of this arena, since the chunk of the running callable can't be reused until it returns.
+			void invoke_front()
+			{
+				pop_front(ArenaOperation::Invoke);
+			}
+
+			// Destroy pending callables without invoking them
+			void clear()
+			{
+				while (!empty())
+				{
+					pop_front(ArenaOperation::Destroy);
+				}
+			}
+
+			// Move all records of the other arena to the end of this one without copying, spare chunks of this arena are given to the other one
+			void append(TaskArena& other)
+			{
+				if (other.m_head == nullptr)
+				{
+					return;
+				}
+
+				if (empty())
+				{
+					if (m_head != nullptr)
+					{
+						recycle_chain();
+						push_spare(m_head);
+					}
+
+					m_head = other.m_head;
+					m_read = other.m_read;
+				}
+				else
+				{
+					m_tail->next = other.m_head;
+				}
+
+				m_tail = other.m_tail;
+				m_size += other.m_size;
+
+				other.m_head = nullptr;
+				other.m_tail = nullptr;
+				other.m_read = 0;
+				other.m_size = 0;
+
+				while (m_spare != nullptr && other.m_spareCount < ADL_TASK_ARENA_SPARE_CHUNKS)
+				{
+					ArenaChunk* chunk = std::exchange(m_spare, m_spare->next);
+					--m_spareCount;
+
+					other.push_spare(chunk);
+				}
+			}
+
+		private:
+
+			static constexpr std::size_t align_up(std::size_t size, std::size_t alignment)
+			{
+				return (size + alignment - 1) / alignment * alignment;
+			}
+
+			template<typename T>
+			static constexpr std::size_t record_size()
+			{
+				return align_up(sizeof(ArenaThunk) + sizeof(T), alignof(ArenaThunk));
+			}
+
+			template<typename F>
+			struct DestroyInline
+			{
+				void operator()(F* callable) const { callable->~F(); }
+			};
+
+			// Record is consumed before the callable is invoked, so the arena stays consistent if the callable throws
+			template<typename F>
+			static void inline_thunk(TaskArena& arena, unsigned char* record, ArenaOperation operation)
+			{
+				const std::unique_ptr<F, DestroyInline<F>> callable{ std::launder(reinterpret_cast<F*>(record + sizeof(ArenaThunk))) };
+				arena.consume(record_size<F>());
+
+				if (operation == ArenaOperation::Invoke)
+				{
+					std::invoke(*callable);
+				}
+			}
+
+			template<typename F>
+			static void heap_thunk(TaskArena& arena, unsigned char* record, ArenaOperation operation)
+			{
+				const std::unique_ptr<F> callable{ *std::launder(reinterpret_cast<F**>(record + sizeof(ArenaThunk))) };
+				arena.consume(record_size<F*>());
+
+				if (operation == ArenaOperation::Invoke)
+				{
+					std::invoke(*callable);
+				}
+			}
+
+			void consume(std::size_t size)
+			{
+				m_read += size;
+				--m_size;
+			}
+
+			static void write_thunk(unsigned char* position, ArenaThunk thunk)
+			{
+				std::memcpy(position, &thunk, sizeof(ArenaThunk));
+			}
+
+			static ArenaThunk read_thunk(const unsigned char* position)
+			{
+				ArenaThunk thunk;
+				std::memcpy(&thunk, position, sizeof(ArenaThunk));
+				return thunk;
+			}
+
+			static void release(ArenaChunk* chunk)
+			{
+				while (chunk != nullptr)
+				{
+					delete std::exchange(chunk, chunk->next);
+				}
+			}
+
+			// Place the record at the end of the tail chunk, a new chunk is linked if it doesn't fit
+			unsigned char* reserve(std::size_t alignment, std::size_t size)
+			{
+				if (m_tail == nullptr || !fits(m_tail->used, alignment, size))
+				{
+					ArenaChunk* chunk = take_spare();
+
+					if (m_tail != nullptr)
+					{
+						m_tail->next = chunk;
+					}
+					else
+					{
+						m_head = chunk;
+						m_read = 0;
+					}
+
+					m_tail = chunk;
+				}
+
+				// Callable follows the thunk, so empty words are written until the callable is aligned
+				const std::size_t padding = (alignment - (m_tail->used + sizeof(ArenaThunk)) % alignment) % alignment;
+
+				for (std::size_t offset = 0; offset < padding; offset += sizeof(ArenaThunk))
+				{
+					write_thunk(m_tail->bytes + m_tail->used + offset, nullptr);
+				}
+
+				unsigned char* record = m_tail->bytes + m_tail->used + padding;
+				m_tail->used += padding + size;
+
+				return record;
+			}
+
+			static bool fits(std::size_t used, std::size_t alignment, std::size_t size)
+			{
+				const std::size_t padding = (alignment - (used + sizeof(ArenaThunk)) % alignment) % alignment;
+				return used + padding + size <= ArenaChunk::CAPACITY;
+			}
+
+			void pop_front(ArenaOperation operation)
+			{
+				// Drained chunks and empty words are skipped, there is at least one record ahead
+				for (;;)
+				{
+					if (m_read == m_head->used)
+					{
+						ArenaChunk* drained = std::exchange(m_head, m_head->next);
+						m_read = 0;
+						push_spare(drained);
+					}
+					else if (read_thunk(m_head->bytes + m_read) == nullptr)
+					{
+						m_read += sizeof(ArenaThunk);
+					}
+					else
+					{
+						break;
+					}
+				}
+
+				assert(!m_invoking && "Task arena is not re-entrant");
+				m_invoking = true;
+
+				const InvokeScope invokeScope{ *this };
+				unsigned char* record = m_head->bytes + m_read;
+				read_thunk(record)(*this, record, operation);
+			}
+
+			// The last chunk is rewound when the arena is drained, even if the callable throws
+			struct InvokeScope
+			{
+				~InvokeScope()
+				{
+					arena.m_invoking = false;
+
+					if (arena.m_size == 0)
+					{
+						arena.recycle_chain();
+					}
+				}
+
+				TaskArena& arena;
+			};
+
+			// Chunks of the empty arena become spare, the first one is kept for the next records
+			void recycle_chain()
+			{
+				if (m_head == nullptr)
+				{
+					return;
+				}
+
+				ArenaChunk* chunk = m_head->next;
+
+				while (chunk != nullptr)
+				{
+					push_spare(std::exchange(chunk, chunk->next));
+				}
+
+				m_head->next = nullptr;
+				m_head->used = 0;
+				m_tail = m_head;
+				m_read = 0;
+			}
+
+			ArenaChunk* take_spare()
+			{
+				if (m_spare == nullptr)
+				{
+					return new ArenaChunk;
+				}
+
+				ArenaChunk* chunk = std::exchange(m_spare, m_spare->next);
+				--m_spareCount;
+
+				chunk->next = nullptr;
+				chunk->used = 0;
+
+				return chunk;
+			}
+
+			void push_spare(ArenaChunk* chunk)
+			{
+				if (m_spareCount == ADL_TASK_ARENA_SPARE_CHUNKS)
+				{
+					delete chunk;
+					return;
+				}
+
+				chunk->next = m_spare;
+				m_spare = chunk;
+				++m_spareCount;
+			}
+
+			ArenaChunk* m_head = nullptr;
+			ArenaChunk* m_tail = nullptr;
+			std::size_t m_read = 0;
+			std::size_t m_size = 0;
+			bool m_invoking = false;
+
+			ArenaChunk* m_spare = nullptr;
+			std::size_t m_spareCount = 0;
+		};
+
+		inline void invoke_front(TaskArena& batch)
+		{
+			batch.invoke_front();
+		}
+
+		// Multi-producer/single-consumer queue of callables of any types placed into an arena, it's guarded by a mutex unless
+		// the queue is single-thread. Consumer takes the whole arena at once and gives its drained chunks back to the producers,
+		// so the queue doesn't allocate once warmed up.
+		template<bool Concurrent = true>
+		class ArenaTaskQueue
+		{
+		public:
+
+			using batch_t = TaskArena;
+
+			static constexpr bool is_concurrent = Concurrent;
+
+			template<typename F>
+			void emplace(F&& callable)
+			{
+				auto lock = lock_tasks();
+				m_tasks.emplace_back(std::forward<F>(callable));
+				m_empty.store(false, std::memory_order_relaxed);
+			}
+
+			template<typename... Args>
+			void emplace_bulk(Args&&... callables)
+			{
+				auto lock = lock_tasks();
+				(..., m_tasks.emplace_back(std::forward<Args>(callables)));
+				m_empty.store(false, std::memory_order_relaxed);
+			}
+
+			// Checked without the lock, tasks are taken under the lock anyway
+			bool empty() const
+			{
+				return m_empty.load(std::memory_order_relaxed);
+			}
+
+			// Append all pending tasks to the consumer batch in FIFO order. Should be called from the consumer thread only.
+			void pop_all(batch_t& batch)
+			{
+				auto lock = lock_tasks();
+
+				if (m_tasks.empty())
+				{
+					return;
+				}
+
+				batch.append(m_tasks);
+				m_empty.store(true, std::memory_order_relaxed);
+			}
+
+		private:
+
+			std::unique_lock<std::mutex> lock_tasks()
+			{
+				if constexpr (Concurrent)
+				{
+					return std::unique_lock{ m_mutex };
+				}
+				else
+				{
+					return {};
+				}
+			}
+
+			std::mutex m_mutex;
+			TaskArena m_tasks;
+			std::atomic_bool m_empty{ true };
+		};
+
+		// Arena stores any callable
+		template<bool Concurrent, typename F>
+		inline constexpr bool is_storable_v<ArenaTaskQueue<Concurrent>, F> = std::is_invocable_v<std::decay_t<F>&>;
+
+		// Single-thread channel drops the lock, other channels keep the arena
+		template<>
+		struct concurrent_task_queue<Concurrency::SingleThread, ArenaTaskQueue<>>
+		{
+			using type = ArenaTaskQueue<false>;
+		};
+
+		template<>
+		struct concurrent_task_queue<Concurrency::SPSC, ArenaTaskQueue<>>
+		{
+			using type = ArenaTaskQueue<>;
+		};
+
+		template<>
+		struct concurrent_task_queue<Concurrency::MPSC, ArenaTaskQueue<>>
+		{
+			using type = ArenaTaskQueue<>;
+		};
+	}
+}
\ No newline at end of file
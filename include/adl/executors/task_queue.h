@@ -0,0 +1,610 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include "../channel.h"
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace adl
+{
+	namespace details
+	{
+		// Callable can be emplaced to the task queue
+		template<typename QueueType, typename F>
+		inline constexpr bool is_storable_v = std::is_constructible_v<typename QueueType::value_type, F>;
+
+		// Take the first task out of the batch and invoke it, so the batch isn't touched by the task
+		template<typename BatchType>
+		void invoke_front(BatchType& batch)
+		{
+			auto task = std::move(batch.front());
+			batch.pop_front();
+
+			std::invoke(task);
+		}
+
+		// Ring of values of a single type in contiguous storage. Capacity is a power of two and doubles when the ring is full,
+		// indexes grow monotonically and are wrapped by the mask, so the storage is reused without moving the values.
+		template<typename T>
+		class RingBuffer
+		{
+		public:
+
+			using value_type = T;
+
+			RingBuffer() = default;
+			RingBuffer(const RingBuffer&) = delete;
+			RingBuffer& operator=(const RingBuffer&) = delete;
+
+			~RingBuffer()
+			{
+				clear();
+
+				if (m_slots != nullptr)
+				{
+					std::allocator<T>{}.deallocate(m_slots, m_capacity);
+				}
+			}
+
+			bool empty() const { return m_head == m_tail; }
+
+			std::size_t size() const { return m_tail - m_head; }
+
+			T& front() { return m_slots[m_head & (m_capacity - 1)]; }
+
+			T& back() { return m_slots[(m_tail - 1) & (m_capacity - 1)]; }
+
+			template<typename... Args>
+			void emplace_back(Args&&... args)
+			{
+				if (size() == m_capacity)
+				{
+					grow();
+				}
+
+				new (&m_slots[m_tail & (m_capacity - 1)]) T(std::forward<Args>(args)...);
+				++m_tail;
+			}
+
+			void pop_front()
+			{
+				front().~T();
+				++m_head;
+			}
+
+			void pop_back()
+			{
+				back().~T();
+				--m_tail;
+			}
+
+			void clear()
+			{
+				while (!empty())
+				{
+					pop_front();
+				}
+			}
+
+			// Storage is exchanged as well, so swapped rings keep their capacity for reuse
+			void swap(RingBuffer& other) noexcept
+			{
+				std::swap(m_slots, other.m_slots);
+				std::swap(m_capacity, other.m_capacity);
+				std::swap(m_head, other.m_head);
+				std::swap(m_tail, other.m_tail);
+			}
+
+		private:
+
+			static constexpr std::size_t MIN_CAPACITY = 16;
+
+			// Values are moved to the new storage in FIFO order starting from the first slot
+			void grow()
+			{
+				const std::size_t capacity = m_capacity == 0 ? MIN_CAPACITY : m_capacity * 2;
+				const std::size_t count = size();
+
+				T* slots = std::allocator<T>{}.allocate(capacity);
+
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					new (&slots[i]) T(std::move(front()));
+					pop_front();
+				}
+
+				if (m_slots != nullptr)
+				{
+					std::allocator<T>{}.deallocate(m_slots, m_capacity);
+				}
+
+				m_slots = slots;
+				m_capacity = capacity;
+				m_head = 0;
+				m_tail = count;
+			}
+
+			T* m_slots = nullptr;
+			std::size_t m_capacity = 0;
+			std::size_t m_head = 0;
+			std::size_t m_tail = 0;
+		};
+
+		// Multi-producer/single-consumer queue guarded by a mutex.
+		// Consumer takes all pending tasks at once, so the lock is taken once per batch instead of once per task.
+		template<typename T, typename Container = RingBuffer<T>>
+		class LockedTaskQueue
+		{
+		public:
+
+			using value_type = T;
+			using batch_t = Container;
+
+			static constexpr bool is_concurrent = true;
+
+			template<typename... Args>
+			void emplace(Args&&... args)
+			{
+				std::unique_lock lock{ m_mutex };
+				m_tasks.emplace_back(std::forward<Args>(args)...);
+				m_empty.store(false, std::memory_order_relaxed);
+			}
+
+			// Push a group of tasks under a single lock, the order of tasks is preserved
+			template<typename... Args>
+			void emplace_bulk(Args&&... values)
+			{
+				std::unique_lock lock{ m_mutex };
+				(..., m_tasks.emplace_back(std::forward<Args>(values)));
+				m_empty.store(false, std::memory_order_relaxed);
+			}
+
+			// Checked without the lock, tasks are taken under the lock anyway
+			bool empty() const
+			{
+				return m_empty.load(std::memory_order_relaxed);
+			}
+
+			// Append all pending tasks to the consumer batch in FIFO order. Should be called from the consumer thread only.
+			void pop_all(batch_t& batch)
+			{
+				std::unique_lock lock{ m_mutex };
+
+				if (m_tasks.empty())
+				{
+					return;
+				}
+
+				if (batch.empty())
+				{
+					batch.swap(m_tasks);
+				}
+				else
+				{
+					while (!m_tasks.empty())
+					{
+						batch.emplace_back(std::move(m_tasks.front()));
+						m_tasks.pop_front();
+					}
+				}
+
+				m_empty.store(true, std::memory_order_relaxed);
+			}
+
+		private:
+
+			mutable std::mutex m_mutex;
+			Container m_tasks;
+			std::atomic_bool m_empty{ true };
+		};
+
+		// Lock-free multi-producer/single-consumer queue.
+		// Producers push nodes to an intrusive stack with a single CAS, consumer takes the whole stack with one exchange
+		// and reverses it to restore FIFO order.
+		template<typename T>
+		class MPSCTaskQueue
+		{
+			struct Node
+			{
+				template<typename... Args>
+				Node(Args&&... args)
+					: value(std::forward<Args>(args)...)
+				{}
+
+				Node* next = nullptr;
+				T value;
+			};
+
+		public:
+
+			using value_type = T;
+
+			static constexpr bool is_concurrent = true;
+
+			// Consumer-owned list of tasks taken from the queue
+			class batch_t
+			{
+			public:
+
+				batch_t() = default;
+				batch_t(const batch_t&) = delete;
+				batch_t& operator=(const batch_t&) = delete;
+
+				batch_t(batch_t&& other) noexcept
+					: m_front{ std::exchange(other.m_front, nullptr) }
+					, m_back{ std::exchange(other.m_back, nullptr) }
+					, m_size{ std::exchange(other.m_size, 0) }
+				{}
+
+				batch_t& operator=(batch_t&& other) noexcept
+				{
+					clear();
+					m_front = std::exchange(other.m_front, nullptr);
+					m_back = std::exchange(other.m_back, nullptr);
+					m_size = std::exchange(other.m_size, 0);
+					return *this;
+				}
+
+				~batch_t()
+				{
+					clear();
+				}
+
+				bool empty() const { return m_front == nullptr; }
+
+				std::size_t size() const { return m_size; }
+
+				T& front() { return m_front->value; }
+
+				void pop_front()
+				{
+					Node* node = m_front;
+					m_front = node->next;
+					--m_size;
+
+					if (m_front == nullptr)
+					{
+						m_back = nullptr;
+					}
+
+					delete node;
+				}
+
+				void clear()
+				{
+					while (!empty())
+					{
+						pop_front();
+					}
+				}
+
+			private:
+
+				friend class MPSCTaskQueue;
+
+				Node* m_front = nullptr;
+				Node* m_back = nullptr;
+				std::size_t m_size = 0;
+			};
+
+			MPSCTaskQueue() = default;
+			MPSCTaskQueue(const MPSCTaskQueue&) = delete;
+			MPSCTaskQueue& operator=(const MPSCTaskQueue&) = delete;
+
+			~MPSCTaskQueue()
+			{
+				batch_t batch;
+				pop_all(batch);
+			}
+
+			template<typename... Args>
+			void emplace(Args&&... args)
+			{
+				Node* node = new Node(std::forward<Args>(args)...);
+				push_chain(node, node);
+			}
+
+			// Push a group of tasks with a single CAS, the order of tasks is preserved
+			template<typename... Args>
+			void emplace_bulk(Args&&... values)
+			{
+				// 'first' is the newest node (top of the chain), 'last' is the oldest one
+				Node* first = nullptr;
+				Node* last = nullptr;
+
+				(..., link(first, last, new Node(std::forward<Args>(values))));
+
+				push_chain(first, last);
+			}
+
+			bool empty() const
+			{
+				return m_head.load(std::memory_order_acquire) == nullptr;
+			}
+
+			// Append all pending tasks to the consumer batch in FIFO order. Should be called from the consumer thread only.
+			void pop_all(batch_t& batch)
+			{
+				Node* head = m_head.exchange(nullptr, std::memory_order_acquire);
+
+				if (head == nullptr)
+				{
+					return;
+				}
+
+				// Stack holds the newest task on top, reverse it
+				Node* back = head;
+				Node* front = nullptr;
+
+				while (head != nullptr)
+				{
+					Node* next = head->next;
+					head->next = front;
+					front = head;
+					head = next;
+					++batch.m_size;
+				}
+
+				if (batch.m_back != nullptr)
+				{
+					batch.m_back->next = front;
+				}
+				else
+				{
+					batch.m_front = front;
+				}
+
+				batch.m_back = back;
+			}
+
+		private:
+
+			static void link(Node*& first, Node*& last, Node* node)
+			{
+				node->next = first;
+				first = node;
+
+				if (last == nullptr)
+				{
+					last = node;
+				}
+			}
+
+			void push_chain(Node* first, Node* last)
+			{
+				Node* head = m_head.load(std::memory_order_relaxed);
+
+				do
+				{
+					last->next = head;
+				}
+				while (!m_head.compare_exchange_weak(head, first, std::memory_order_release, std::memory_order_relaxed));
+			}
+
+			std::atomic<Node*> m_head{ nullptr };
+		};
+
+		// Queue without synchronization, tasks are posted and dispatched by the same thread
+		template<typename T, typename Container = RingBuffer<T>>
+		class UnsyncTaskQueue
+		{
+		public:
+
+			using value_type = T;
+			using batch_t = Container;
+
+			static constexpr bool is_concurrent = false;
+
+			template<typename... Args>
+			void emplace(Args&&... args)
+			{
+				m_tasks.emplace_back(std::forward<Args>(args)...);
+			}
+
+			template<typename... Args>
+			void emplace_bulk(Args&&... values)
+			{
+				(..., m_tasks.emplace_back(std::forward<Args>(values)));
+			}
+
+			bool empty() const
+			{
+				return m_tasks.empty();
+			}
+
+			void pop_all(batch_t& batch)
+			{
+				if (batch.empty())
+				{
+					batch.swap(m_tasks);
+				}
+				else
+				{
+					while (!m_tasks.empty())
+					{
+						batch.emplace_back(std::move(m_tasks.front()));
+						m_tasks.pop_front();
+					}
+				}
+			}
+
+		private:
+
+			Container m_tasks;
+		};
+
+		// Wait-free single-producer/single-consumer queue made of fixed size ring segments.
+		// Producer links a new segment when the current one is full, consumer hands the drained segment back for reuse,
+		// so the queue doesn't allocate once warmed up unless the consumer falls behind by more than a segment.
+		template<typename T, std::size_t SegmentSize = 64>
+		class SPSCTaskQueue
+		{
+			struct Segment
+			{
+				std::atomic<Segment*> next{ nullptr };
+				alignas(T) unsigned char slots[SegmentSize][sizeof(T)];
+
+				T* slot(std::size_t index)
+				{
+					return std::launder(reinterpret_cast<T*>(slots[index]));
+				}
+			};
+
+		public:
+
+			using value_type = T;
+			using batch_t = std::deque<T>;
+
+			static constexpr bool is_concurrent = true;
+
+			SPSCTaskQueue()
+				: m_tail{ new Segment }
+				, m_head{ m_tail }
+			{}
+
+			SPSCTaskQueue(const SPSCTaskQueue&) = delete;
+			SPSCTaskQueue& operator=(const SPSCTaskQueue&) = delete;
+
+			~SPSCTaskQueue()
+			{
+				batch_t batch;
+				pop_all(batch);
+
+				delete m_head;
+				delete m_spare.load(std::memory_order_relaxed);
+			}
+
+			// Should be called from the producer thread only
+			template<typename... Args>
+			void emplace(Args&&... args)
+			{
+				push(std::forward<Args>(args)...);
+				m_written.store(m_pushed, std::memory_order_release);
+			}
+
+			// Tasks are published at once, should be called from the producer thread only
+			template<typename... Args>
+			void emplace_bulk(Args&&... values)
+			{
+				(..., push(std::forward<Args>(values)));
+				m_written.store(m_pushed, std::memory_order_release);
+			}
+
+			// Should be called from the consumer thread only
+			bool empty() const
+			{
+				return m_written.load(std::memory_order_acquire) == m_read;
+			}
+
+			// Append all published tasks to the consumer batch in FIFO order. Should be called from the consumer thread only.
+			void pop_all(batch_t& batch)
+			{
+				const std::size_t written = m_written.load(std::memory_order_acquire);
+
+				for (; m_read != written; ++m_read)
+				{
+					if (m_headIndex == SegmentSize)
+					{
+						// Next segment is linked before the tasks in it are published
+						Segment* drained = std::exchange(m_head, m_head->next.load(std::memory_order_relaxed));
+						m_headIndex = 0;
+						recycle(drained);
+					}
+
+					T* task = m_head->slot(m_headIndex++);
+					batch.emplace_back(std::move(*task));
+					task->~T();
+				}
+			}
+
+		private:
+
+			template<typename... Args>
+			void push(Args&&... args)
+			{
+				if (m_tailIndex == SegmentSize)
+				{
+					Segment* segment = m_spare.exchange(nullptr, std::memory_order_acquire);
+
+					if (segment != nullptr)
+					{
+						segment->next.store(nullptr, std::memory_order_relaxed);
+					}
+					else
+					{
+						segment = new Segment;
+					}
+
+					m_tail->next.store(segment, std::memory_order_relaxed);
+					m_tail = segment;
+					m_tailIndex = 0;
+				}
+
+				new (m_tail->slots[m_tailIndex++]) T(std::forward<Args>(args)...);
+				++m_pushed;
+			}
+
+			// Only one spare segment is kept, the others are released
+			void recycle(Segment* segment)
+			{
+				delete m_spare.exchange(segment, std::memory_order_acq_rel);
+			}
+
+			// Producer state
+			alignas(64) Segment* m_tail;
+			std::size_t m_tailIndex = 0;
+			std::size_t m_pushed = 0;
+
+			// Consumer state
+			alignas(64) Segment* m_head;
+			std::size_t m_headIndex = 0;
+			std::size_t m_read = 0;
+
+			alignas(64) std::atomic<std::size_t> m_written{ 0 };
+			std::atomic<Segment*> m_spare{ nullptr };
+		};
+
+		// Task queue which matches the concurrency of the channel, MPMC channels keep the queue of the executor
+		template<Concurrency ConcurrencyType, typename QueueType>
+		struct concurrent_task_queue
+		{
+			using type = QueueType;
+		};
+
+		template<typename QueueType>
+		struct concurrent_task_queue<Concurrency::SingleThread, QueueType>
+		{
+			using type = UnsyncTaskQueue<typename QueueType::value_type>;
+		};
+
+		// Storage of the locked queue is kept by the single-thread one
+		template<typename T, typename Container>
+		struct concurrent_task_queue<Concurrency::SingleThread, LockedTaskQueue<T, Container>>
+		{
+			using type = UnsyncTaskQueue<T, Container>;
+		};
+
+		template<typename QueueType>
+		struct concurrent_task_queue<Concurrency::SPSC, QueueType>
+		{
+			using type = SPSCTaskQueue<typename QueueType::value_type>;
+		};
+
+		template<typename QueueType>
+		struct concurrent_task_queue<Concurrency::MPSC, QueueType>
+		{
+			using type = MPSCTaskQueue<typename QueueType::value_type>;
+		};
+
+		template<Concurrency ConcurrencyType, typename QueueType>
+		using concurrent_task_queue_t = typename concurrent_task_queue<ConcurrencyType, QueueType>::type;
+	}
+}
\ No newline at end of file
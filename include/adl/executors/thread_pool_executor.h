@@ -0,0 +1,302 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include "executor.h"
+#include "execution_agent.h"
+#include "executor_stats.h"
+#include "task_queue.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace adl {
+
+	// Executor with a fixed set of worker threads. Every worker owns a deque of tasks,
+	// tasks posted from a worker thread go to its own deque, idle workers steal tasks from the others.
+	class ThreadPoolExecutor
+	{
+	public:
+
+		ThreadPoolExecutor()
+			: ThreadPoolExecutor(std::max(std::thread::hardware_concurrency(), 1u))
+		{}
+
+		explicit ThreadPoolExecutor(size_t workersCount)
+		{
+			m_workers.reserve(workersCount);
+
+			for (size_t i = 0; i < workersCount; ++i)
+			{
+				m_workers.emplace_back(std::make_unique<Worker>());
+			}
+
+			for (size_t i = 0; i < workersCount; ++i)
+			{
+				m_workers[i]->thread = std::thread{ &ThreadPoolExecutor::run, this, i };
+			}
+		}
+
+		ThreadPoolExecutor(const ThreadPoolExecutor&) = delete;
+		ThreadPoolExecutor& operator=(const ThreadPoolExecutor&) = delete;
+
+		// Pending tasks are executed before workers are stopped
+		~ThreadPoolExecutor()
+		{
+			{
+				std::unique_lock lock{ m_mutex };
+				m_stopped = true;
+			}
+
+			m_condition.notify_all();
+
+			for (auto&& worker : m_workers)
+			{
+				worker->thread.join();
+			}
+		}
+
+		template<typename F>
+		void execute(F&& callable)
+		{
+			push(std::forward<F>(callable));
+		}
+
+		template<typename... Args>
+		void bulk_execute(Args&&... callables)
+		{
+			push(std::forward<Args>(callables)...);
+		}
+
+		template<typename F>
+		void defer_execute(F&& callable)
+		{
+			// Deferred task goes to the next worker in order, so it is not picked up again by the current worker right away
+			m_stats.on_defer();
+			push_to(next_worker(), std::forward<F>(callable));
+		}
+
+		template<typename F>
+		auto future_execute(F&& callable)
+		{
+			auto promise = details::make_promise<F>();
+			auto future = details::get_future(promise);
+
+			push(details::make_task(std::move(promise), std::forward<F>(callable)));
+
+			return future;
+		}
+
+		template<typename... Args>
+		auto future_bulk_execute(Args&&... callables)
+		{
+			auto promises = details::make_promises<Args...>();
+			auto futures = details::get_futures(promises);
+			auto tasks = details::make_tasks(std::move(promises), std::forward<Args>(callables)...);
+
+			std::apply([this](auto&&... args) { push(std::forward<decltype(args)>(args)...); }, std::move(tasks));
+
+			return futures;
+		}
+
+		// Tasks are dispatched by worker threads
+		void dispatch()
+		{
+			[[maybe_unused]] const auto statsScope = m_stats.dispatch_scope();
+		}
+
+		ExecutorStats stats() const
+		{
+			return m_stats.snapshot();
+		}
+
+		size_t workers_count() const
+		{
+			return m_workers.size();
+		}
+
+	private:
+
+		using task_t = ExecutionAgent<>;
+
+		struct alignas(64) Worker
+		{
+			std::mutex mutex;
+			details::RingBuffer<task_t> tasks;
+			std::thread thread;
+		};
+
+		struct WorkerContext
+		{
+			const ThreadPoolExecutor* executor = nullptr;
+			size_t index = 0;
+		};
+
+		static WorkerContext& current_worker()
+		{
+			thread_local WorkerContext context;
+			return context;
+		}
+
+		// Return worker for the task posted from the current thread, worker threads push to their own deques
+		size_t local_worker()
+		{
+			const WorkerContext& context = current_worker();
+			return context.executor == this ? context.index : next_worker();
+		}
+
+		size_t next_worker()
+		{
+			return m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+		}
+
+		template<typename... Args>
+		void push(Args&&... callables)
+		{
+			push_to(local_worker(), std::forward<Args>(callables)...);
+		}
+
+		template<typename... Args>
+		void push_to(size_t index, Args&&... callables)
+		{
+			Worker& worker = *m_workers[index];
+
+			// Counter is increased before the push so it never underflows when the task is taken right away
+			m_pendingTasks.fetch_add(sizeof...(Args));
+			m_stats.on_post(sizeof...(Args));
+
+			{
+				std::unique_lock lock{ worker.mutex };
+				(..., worker.tasks.emplace_back(std::forward<Args>(callables)));
+			}
+
+			// Every posted task can wake up a sleeping worker
+			wake(sizeof...(Args));
+		}
+
+		// Wake up to count sleeping workers, the check of sleeping workers is paired with the check of pending tasks in wait()
+		void wake(size_t count)
+		{
+			const size_t sleeping = m_sleepingWorkers.load();
+
+			if (sleeping == 0)
+			{
+				return;
+			}
+
+			std::unique_lock lock{ m_mutex };
+
+			if (count >= sleeping)
+			{
+				m_condition.notify_all();
+			}
+			else
+			{
+				for (size_t i = 0; i < count; ++i)
+				{
+					m_condition.notify_one();
+				}
+			}
+		}
+
+		// Owner takes the newest task from the back of its deque
+		bool pop(size_t index, task_t& task)
+		{
+			Worker& worker = *m_workers[index];
+			std::unique_lock lock{ worker.mutex };
+
+			if (worker.tasks.empty())
+			{
+				return false;
+			}
+
+			task = std::move(worker.tasks.back());
+			worker.tasks.pop_back();
+			return true;
+		}
+
+		// Thieves take the oldest task from the front of the other deques
+		bool steal(size_t index, task_t& task)
+		{
+			for (size_t i = 1; i < m_workers.size(); ++i)
+			{
+				Worker& victim = *m_workers[(index + i) % m_workers.size()];
+				std::unique_lock lock{ victim.mutex, std::try_to_lock };
+
+				if (lock.owns_lock() && !victim.tasks.empty())
+				{
+					task = std::move(victim.tasks.front());
+					victim.tasks.pop_front();
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		// Returns false if executor is stopped and there are no pending tasks
+		bool wait()
+		{
+			std::unique_lock lock{ m_mutex };
+
+			m_sleepingWorkers.fetch_add(1);
+			m_condition.wait(lock, [this] { return m_stopped || m_pendingTasks.load() > 0; });
+			m_sleepingWorkers.fetch_sub(1);
+
+			return m_pendingTasks.load() > 0;
+		}
+
+		void run(size_t index)
+		{
+			current_worker() = WorkerContext{ this, index };
+
+			task_t task;
+
+			while (true)
+			{
+				if (pop(index, task) || steal(index, task))
+				{
+					// More work is queued, so another sleeping worker is woken up to steal it while this one is busy
+					if (m_pendingTasks.fetch_sub(1) > 1)
+					{
+						wake(1);
+					}
+
+					{
+						[[maybe_unused]] const auto statsScope = m_stats.execute_scope();
+						task();
+						task.reset();
+					}
+
+					m_stats.on_execute(1);
+				}
+				else if (m_pendingTasks.load() > 0)
+				{
+					// Task is being pushed or its deque is locked by another worker
+					std::this_thread::yield();
+				}
+				else if (!wait())
+				{
+					break;
+				}
+			}
+
+			current_worker() = WorkerContext{};
+		}
+
+		std::vector<std::unique_ptr<Worker>> m_workers;
+		std::atomic_size_t m_nextWorker{ 0 };
+		std::atomic_size_t m_pendingTasks{ 0 };
+		std::atomic_size_t m_sleepingWorkers{ 0 };
+		details::executor_stats_t m_stats;
+
+		std::mutex m_mutex;
+		std::condition_variable m_condition;
+		bool m_stopped = false;
+	};
+
+}
\ No newline at end of file
@@ -0,0 +1,341 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include "../priority.h"
+#include "execution_agent.h"
+#include "timing_wheel.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Resolution of the timers in microseconds, timers never expire earlier than requested
+#ifndef ADL_TIMER_TICK_US
+#define ADL_TIMER_TICK_US 1000
+#endif
+
+namespace adl
+{
+	class TimerExecutor;
+
+	// Handle of the scheduled timer, it doesn't own the timer
+	class TimerHandle
+	{
+	public:
+
+		TimerHandle() = default;
+
+		// Returns false if the timer is already expired or canceled, periodic timers are canceled at any time
+		bool cancel();
+
+	private:
+
+		friend class TimerExecutor;
+
+		struct Payload
+		{
+			// Posts the expired agent to the channel executor with priority of the agent which scheduled the timer
+			void (*post)(Priority, ExecutionAgent<>&&) = nullptr;
+			Priority priority = Priority::Normal;
+			ExecutionAgent<> agent;
+			// Periodic timers make a new agent from the shared callable on every expiry
+			std::shared_ptr<void> callable;
+			ExecutionAgent<> (*make_agent)(const std::shared_ptr<void>&) = nullptr;
+			std::chrono::steady_clock::time_point deadline;
+			std::chrono::steady_clock::duration period{ 0 };
+		};
+
+		using wheel_t = details::TimingWheel<Payload>;
+
+		TimerHandle(TimerExecutor* executor, typename wheel_t::Handle handle)
+			: m_executor{ executor }
+			, m_handle{ handle }
+		{}
+
+		TimerExecutor* m_executor = nullptr;
+		typename wheel_t::Handle m_handle;
+	};
+
+	// Owns a thread which advances the timing wheel and posts expired agents to their channels.
+	// Agents expired on the same tick are delivered as a single batch per channel.
+	class TimerExecutor
+	{
+	public:
+
+		using clock = std::chrono::steady_clock;
+
+		TimerExecutor()
+			: m_start{ clock::now() }
+			, m_thread{ [this] { run(); } }
+		{}
+
+		TimerExecutor(const TimerExecutor&) = delete;
+		TimerExecutor& operator=(const TimerExecutor&) = delete;
+
+		// Pending timers are dropped
+		~TimerExecutor()
+		{
+			{
+				std::unique_lock lock{ m_mutex };
+				m_stopped = true;
+			}
+
+			m_wakeup.notify_one();
+			m_thread.join();
+		}
+
+		// Post the callable with the post function when the deadline is reached
+		template<typename F>
+		TimerHandle schedule(clock::time_point deadline, void (*post)(Priority, ExecutionAgent<>&&), F&& callable)
+		{
+			TimerHandle::Payload payload;
+			payload.post = post;
+			payload.priority = details::current_priority();
+			payload.agent = ExecutionAgent<>{ std::forward<F>(callable) };
+			payload.deadline = deadline;
+
+			return insert(std::move(payload));
+		}
+
+		// Post the callable every period starting from the deadline. Deadlines are advanced by the period from the previous
+		// deadline rather than from the expiry time, so the delays don't accumulate, missed periods are skipped.
+		template<typename F>
+		TimerHandle schedule_periodic(clock::time_point deadline, clock::duration period, void (*post)(Priority, ExecutionAgent<>&&), F&& callable)
+		{
+			using callable_t = std::decay_t<F>;
+
+			TimerHandle::Payload payload;
+			payload.post = post;
+			payload.priority = details::current_priority();
+			payload.callable = std::make_shared<callable_t>(std::forward<F>(callable));
+			payload.make_agent = [](const std::shared_ptr<void>& callable) -> ExecutionAgent<>
+			{
+				return [callable = std::static_pointer_cast<callable_t>(callable)] { (*callable)(); };
+			};
+			payload.deadline = deadline;
+			payload.period = std::max<clock::duration>(period, std::chrono::microseconds{ ADL_TIMER_TICK_US });
+
+			return insert(std::move(payload));
+		}
+
+		// Cancel pending timers which post with the post function and wait until the expired ones are delivered,
+		// so the target executor can be destroyed after the call. Returns the number of canceled timers.
+		size_t cancel_all(void (*post)(Priority, ExecutionAgent<>&&))
+		{
+			std::unique_lock lock{ m_mutex };
+			const size_t canceled = m_wheel.cancel_if([post](const TimerHandle::Payload& payload) { return payload.post == post; });
+
+			// Timer thread can't wait for itself
+			if (std::this_thread::get_id() != m_thread.get_id())
+			{
+				m_delivered.wait(lock, [this] { return !m_delivering; });
+			}
+
+			return canceled;
+		}
+
+		// Number of pending timers
+		size_t size() const
+		{
+			std::unique_lock lock{ m_mutex };
+			return m_wheel.size();
+		}
+
+	private:
+
+		friend class TimerHandle;
+
+		using wheel_t = TimerHandle::wheel_t;
+		using node_t = typename wheel_t::Node;
+
+		struct Expired
+		{
+			void (*post)(Priority, ExecutionAgent<>&&);
+			Priority priority;
+			ExecutionAgent<> agent;
+		};
+
+		static constexpr std::chrono::microseconds TICK{ ADL_TIMER_TICK_US };
+
+		// Deadlines are rounded up, so timers don't expire earlier
+		uint64_t to_tick(clock::time_point deadline) const
+		{
+			if (deadline <= m_start)
+			{
+				return 0;
+			}
+
+			return static_cast<uint64_t>((deadline - m_start + TICK - clock::duration{ 1 }) / TICK);
+		}
+
+		uint64_t current_tick() const
+		{
+			return static_cast<uint64_t>((clock::now() - m_start) / TICK);
+		}
+
+		TimerHandle insert(TimerHandle::Payload&& payload)
+		{
+			const uint64_t tick = to_tick(payload.deadline);
+			bool wakeup = false;
+
+			typename wheel_t::Handle handle;
+
+			{
+				std::unique_lock lock{ m_mutex };
+				handle = m_wheel.insert(tick, std::move(payload));
+
+				// Thread is woken only if it sleeps past the new timer
+				if (tick < m_wakeupTick)
+				{
+					m_wakeupTick = tick;
+					wakeup = true;
+				}
+			}
+
+			if (wakeup)
+			{
+				m_wakeup.notify_one();
+			}
+
+			return TimerHandle{ this, handle };
+		}
+
+		bool cancel(const typename wheel_t::Handle& handle)
+		{
+			std::unique_lock lock{ m_mutex };
+			return m_wheel.cancel(handle);
+		}
+
+		void run()
+		{
+			std::unique_lock lock{ m_mutex };
+
+			while (!m_stopped)
+			{
+				m_wheel.advance(current_tick(), m_expired);
+
+				for (node_t* node : m_expired)
+				{
+					collect(*node);
+				}
+
+				m_expired.clear();
+
+				// Sleep until the nearest slot with timers or forever if there are no timers
+				m_wakeupTick = m_wheel.empty() ? UINT64_MAX : m_wheel.next_tick();
+
+				if (!m_batch.empty())
+				{
+					m_delivering = true;
+					lock.unlock();
+					deliver();
+					lock.lock();
+					m_delivering = false;
+					m_delivered.notify_all();
+					continue;
+				}
+
+				if (m_wakeupTick == UINT64_MAX)
+				{
+					m_wakeup.wait(lock, [this] { return m_stopped || m_wakeupTick != UINT64_MAX; });
+				}
+				else
+				{
+					m_wakeup.wait_until(lock, m_start + m_wakeupTick * TICK);
+				}
+			}
+		}
+
+		// Move agent of the expired timer to the batch, periodic timers are inserted again
+		void collect(node_t& node)
+		{
+			TimerHandle::Payload& payload = node.payload;
+
+			if (payload.make_agent == nullptr)
+			{
+				m_batch.push_back({ payload.post, payload.priority, std::move(payload.agent) });
+				m_wheel.release(&node);
+				return;
+			}
+
+			m_batch.push_back({ payload.post, payload.priority, payload.make_agent(payload.callable) });
+
+			const clock::time_point now = clock::now();
+			payload.deadline += payload.period;
+
+			if (payload.deadline <= now)
+			{
+				payload.deadline += (now - payload.deadline) / payload.period * payload.period + payload.period;
+			}
+
+			m_wheel.reinsert(&node, to_tick(payload.deadline));
+		}
+
+		// Agents of the same channel and priority are posted as a single agent
+		void deliver()
+		{
+			std::stable_sort(m_batch.begin(), m_batch.end(), [](const Expired& lhs, const Expired& rhs)
+			{
+				return lhs.post != rhs.post ? std::less<>{}(lhs.post, rhs.post) : lhs.priority < rhs.priority;
+			});
+
+			for (auto begin = m_batch.begin(); begin != m_batch.end(); )
+			{
+				auto end = std::find_if(begin, m_batch.end(), [&first = *begin](const Expired& item) { return item.post != first.post || item.priority != first.priority; });
+
+				if (end - begin == 1)
+				{
+					begin->post(begin->priority, std::move(begin->agent));
+				}
+				else
+				{
+					std::vector<ExecutionAgent<>> agents;
+					agents.reserve(end - begin);
+
+					for (auto it = begin; it != end; ++it)
+					{
+						agents.push_back(std::move(it->agent));
+					}
+
+					begin->post(begin->priority, [agents = std::move(agents)]() mutable
+					{
+						for (auto&& agent : agents)
+						{
+							agent();
+						}
+					});
+				}
+
+				begin = end;
+			}
+
+			m_batch.clear();
+		}
+
+		const clock::time_point m_start;
+		mutable std::mutex m_mutex;
+		std::condition_variable m_wakeup;
+		std::condition_variable m_delivered;
+		wheel_t m_wheel;
+		uint64_t m_wakeupTick = UINT64_MAX;
+		bool m_stopped = false;
+		// Set while the expired agents are posted without the lock
+		bool m_delivering = false;
+		// Used by the timer thread only
+		std::vector<node_t*> m_expired;
+		std::vector<Expired> m_batch;
+		std::thread m_thread;
+	};
+
+	inline bool TimerHandle::cancel()
+	{
+		return m_executor != nullptr && m_executor->cancel(m_handle);
+	}
+}
\ No newline at end of file
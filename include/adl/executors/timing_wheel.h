@@ -0,0 +1,296 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace adl
+{
+	namespace details
+	{
+		// Hierarchical timing wheel, every level has 256 slots and a slot of the level covers all slots of the level below.
+		// Timers are kept in intrusive lists, so insert and cancel are O(1), timers of the higher levels are cascaded down
+		// when the lower level wraps around. Not thread safe.
+		template<typename Payload>
+		class TimingWheel
+		{
+		public:
+
+			static constexpr size_t SLOT_BITS = 8;
+			static constexpr size_t SLOTS = size_t{ 1 } << SLOT_BITS;
+			static constexpr size_t LEVELS = 4;
+
+			struct Node
+			{
+				uint64_t expiry = 0;
+				Node* prev = nullptr;
+				Node* next = nullptr;
+				Node** slot = nullptr;
+				// Incremented when the node is released, so stale handles can be detected
+				uint32_t generation = 0;
+				Payload payload{};
+			};
+
+			// Handle stays valid until the timer is expired or canceled
+			struct Handle
+			{
+				Node* node = nullptr;
+				uint32_t generation = 0;
+			};
+
+			TimingWheel()
+			{
+				for (auto&& level : m_slots)
+				{
+					level.fill(nullptr);
+				}
+			}
+
+			TimingWheel(const TimingWheel&) = delete;
+			TimingWheel& operator=(const TimingWheel&) = delete;
+
+			uint64_t now() const
+			{
+				return m_current;
+			}
+
+			size_t size() const
+			{
+				return m_size;
+			}
+
+			bool empty() const
+			{
+				return m_size == 0;
+			}
+
+			// Timer expires on the first tick which is not less than expiry
+			Handle insert(uint64_t expiry, Payload payload)
+			{
+				Node* node = acquire();
+				node->payload = std::move(payload);
+				reinsert(node, expiry);
+
+				return { node, node->generation };
+			}
+
+			// Insert expired timer again without releasing it, handle stays valid.
+			// Current tick is already advanced, so timers which are already expired expire on the next one.
+			void reinsert(Node* node, uint64_t expiry)
+			{
+				node->expiry = expiry > m_current ? expiry : m_current + 1;
+				link(node);
+				++m_size;
+			}
+
+			bool contains(const Handle& handle) const
+			{
+				return handle.node != nullptr && handle.node->generation == handle.generation && handle.node->slot != nullptr;
+			}
+
+			// Returns false if the timer is already expired or canceled
+			bool cancel(const Handle& handle)
+			{
+				if (!contains(handle))
+				{
+					return false;
+				}
+
+				unlink(handle.node);
+				release(handle.node);
+				--m_size;
+
+				return true;
+			}
+
+			// Cancel all timers whose payload satisfies the predicate, returns the number of canceled timers
+			template<typename Predicate>
+			size_t cancel_if(Predicate&& predicate)
+			{
+				size_t canceled = 0;
+
+				for (auto&& level : m_slots)
+				{
+					for (Node*& head : level)
+					{
+						for (Node* node = head; node != nullptr; )
+						{
+							Node* next = node->next;
+
+							if (predicate(std::as_const(node->payload)))
+							{
+								unlink(node);
+								release(node);
+								++canceled;
+							}
+
+							node = next;
+						}
+					}
+				}
+
+				m_size -= canceled;
+				return canceled;
+			}
+
+			// Advance the wheel until the tick, expired nodes are appended to the output and should be released or reinserted
+			void advance(uint64_t tick, std::vector<Node*>& expired)
+			{
+				while (m_current < tick)
+				{
+					++m_current;
+
+					// Higher levels are cascaded first, so their timers can land into the lower levels which are cascaded next
+					size_t level = 0;
+
+					while (level + 1 < LEVELS && (m_current & ((uint64_t{ 1 } << (SLOT_BITS * (level + 1))) - 1)) == 0)
+					{
+						++level;
+					}
+
+					for (; level > 0; --level)
+					{
+						Node* node = take(m_slots[level][index(m_current, level)]);
+
+						while (node != nullptr)
+						{
+							Node* next = node->next;
+							link(node);
+							node = next;
+						}
+					}
+
+					const size_t first = expired.size();
+
+					for (Node* node = take(m_slots[0][index(m_current, 0)]); node != nullptr; node = node->next)
+					{
+						--m_size;
+						expired.push_back(node);
+					}
+
+					// Slot lists are LIFO, timers with the same expiry are expired in order of insertion
+					std::reverse(expired.begin() + first, expired.end());
+				}
+			}
+
+			// Nearest tick at which the wheel has to be advanced, ticks without timers are skipped up to the next cascade
+			uint64_t next_tick() const
+			{
+				for (uint64_t tick = m_current + 1; tick <= m_current + SLOTS; ++tick)
+				{
+					if (index(tick, 0) == 0 || m_slots[0][index(tick, 0)] != nullptr)
+					{
+						return tick;
+					}
+				}
+
+				return m_current + SLOTS;
+			}
+
+			// Release expired node, its handles become invalid
+			void release(Node* node)
+			{
+				node->payload = Payload{};
+				++node->generation;
+				m_free.push_back(node);
+			}
+
+		private:
+
+			static size_t index(uint64_t tick, size_t level)
+			{
+				return static_cast<size_t>(tick >> (SLOT_BITS * level)) & (SLOTS - 1);
+			}
+
+			Node* acquire()
+			{
+				if (m_free.empty())
+				{
+					return &m_nodes.emplace_back();
+				}
+
+				Node* node = m_free.back();
+				m_free.pop_back();
+				return node;
+			}
+
+			void link(Node* node)
+			{
+				const uint64_t delta = node->expiry > m_current ? node->expiry - m_current : 0;
+
+				// Timers which don't fit into the wheel are put into the furthest slot and cascaded again
+				constexpr uint64_t MAX_DELTA = (uint64_t{ 1 } << (SLOT_BITS * LEVELS)) - 1;
+				const uint64_t expiry = m_current + (delta < MAX_DELTA ? delta : MAX_DELTA);
+
+				size_t level = 0;
+
+				while (level + 1 < LEVELS && delta >= (uint64_t{ 1 } << (SLOT_BITS * (level + 1))))
+				{
+					++level;
+				}
+
+				// Cascaded timers which expire on the current tick are put into the current slot, which is expired after cascading
+				Node*& head = m_slots[level][index(expiry, level)];
+
+				node->prev = nullptr;
+				node->next = head;
+				node->slot = &head;
+
+				if (head != nullptr)
+				{
+					head->prev = node;
+				}
+
+				head = node;
+			}
+
+			void unlink(Node* node)
+			{
+				if (node->prev != nullptr)
+				{
+					node->prev->next = node->next;
+				}
+				else
+				{
+					*node->slot = node->next;
+				}
+
+				if (node->next != nullptr)
+				{
+					node->next->prev = node->prev;
+				}
+
+				node->prev = nullptr;
+				node->next = nullptr;
+				node->slot = nullptr;
+			}
+
+			// Detach the whole slot list
+			Node* take(Node*& head)
+			{
+				Node* node = head;
+				head = nullptr;
+
+				for (Node* it = node; it != nullptr; it = it->next)
+				{
+					it->slot = nullptr;
+				}
+
+				return node;
+			}
+
+			std::array<std::array<Node*, SLOTS>, LEVELS> m_slots;
+			// Deque keeps node addresses stable while the pool grows
+			std::deque<Node> m_nodes;
+			std::vector<Node*> m_free;
+			uint64_t m_current = 0;
+			size_t m_size = 0;
+		};
+	}
+}
\ No newline at end of file
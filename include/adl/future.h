@@ -0,0 +1,532 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include "atomic_wait.h"
+#include "placeholder.h"
+#include "executors/execution_agent.h"
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <new>
+#include <optional>
+#include <utility>
+
+// Number of spins in future::wait before the thread is parked
+#ifndef ADL_FUTURE_SPIN_COUNT
+#define ADL_FUTURE_SPIN_COUNT 1024
+#endif
+
+// Number of released shared states cached per thread for reuse, 0 disables pooling
+#ifndef ADL_FUTURE_STATE_POOL_CAPACITY
+#define ADL_FUTURE_STATE_POOL_CAPACITY 64
+#endif
+
+namespace adl
+{
+	template<typename T>
+	class future;
+
+	template<typename T>
+	class promise;
+
+	// Defined in dispatcher.h
+	template<typename ChannelType, typename CallableType>
+	static void post(CallableType&& callable);
+
+	namespace details
+	{
+		// Per-thread cache of memory blocks of the same size
+		template<std::size_t Size, std::size_t Capacity>
+		class ThreadLocalPool
+		{
+			struct Block
+			{
+				Block* next;
+			};
+
+			static_assert(Size >= sizeof(Block), "Block should fit into the pooled memory");
+
+			// Free list is trivially destructible, so it stays accessible after the cleanup at the thread exit
+			struct FreeList
+			{
+				Block* head;
+				std::size_t count;
+				bool released;
+			};
+
+			struct Cleanup
+			{
+				~Cleanup()
+				{
+					FreeList& list = free_list();
+
+					while (list.head != nullptr)
+					{
+						::operator delete(std::exchange(list.head, list.head->next));
+					}
+
+					list.count = 0;
+					list.released = true;
+				}
+			};
+
+			static FreeList& free_list()
+			{
+				thread_local FreeList list{ nullptr, 0, false };
+				return list;
+			}
+
+		public:
+
+			static void* allocate()
+			{
+				FreeList& list = free_list();
+
+				if (list.head != nullptr)
+				{
+					--list.count;
+					return std::exchange(list.head, list.head->next);
+				}
+
+				return ::operator new(Size);
+			}
+
+			static void deallocate(void* memory)
+			{
+				FreeList& list = free_list();
+
+				if (list.count < Capacity && !list.released)
+				{
+					// Cleanup is registered when the first block is cached on the thread
+					thread_local Cleanup cleanup;
+					(void)cleanup;
+
+					list.head = new (memory) Block{ list.head };
+					++list.count;
+				}
+				else
+				{
+					::operator delete(memory);
+				}
+			}
+		};
+
+		// State shared between promise and future, the only allocation of the pair
+		template<typename T>
+		class SharedState
+		{
+		public:
+
+			using value_t = void_to_placeholder_t<T>;
+
+			static SharedState* create()
+			{
+				if constexpr (is_pooled)
+				{
+					return new (ThreadLocalPool<sizeof(SharedState), ADL_FUTURE_STATE_POOL_CAPACITY>::allocate()) SharedState;
+				}
+				else
+				{
+					return new SharedState;
+				}
+			}
+
+			void add_ref()
+			{
+				m_refs.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			void release()
+			{
+				if (m_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					destroy(this);
+				}
+			}
+
+			template<typename... Args>
+			void set_value(Args&&... args)
+			{
+				m_value.emplace(std::forward<Args>(args)...);
+				set_state(Ready);
+			}
+
+			void set_broken()
+			{
+				set_state(Broken);
+			}
+
+			// Continuation is posted by the thread which sets the value, or right away if the value is already set
+			void set_continuation(ExecutionAgent<>&& continuation, void (*post)(ExecutionAgent<>&&))
+			{
+				m_continuation = std::move(continuation);
+				m_post = post;
+
+				uint32_t state = Empty;
+
+				if (!m_state.compare_exchange_strong(state, Continued, std::memory_order_acq_rel))
+				{
+					post_continuation();
+				}
+			}
+
+			bool is_ready() const
+			{
+				const uint32_t state = m_state.load(std::memory_order_acquire);
+				return state == Ready || state == Broken;
+			}
+
+			bool is_broken() const
+			{
+				return m_state.load(std::memory_order_acquire) == Broken;
+			}
+
+			// Spin for a while and then park the thread until the value is set
+			void wait()
+			{
+				if (spin_until([this] { return is_ready(); }, ADL_FUTURE_SPIN_COUNT))
+				{
+					return;
+				}
+
+				uint32_t state = m_state.load(std::memory_order_acquire);
+
+				while (state == Empty || state == Waiting)
+				{
+					// Mark that there is a waiter, so the producer will wake it up
+					if (state == Waiting || m_state.compare_exchange_weak(state, Waiting, std::memory_order_acquire))
+					{
+						atomic_wait(m_state, Waiting);
+					}
+
+					state = m_state.load(std::memory_order_acquire);
+				}
+			}
+
+			// Should be called after the wait, if the promise isn't broken
+			value_t get()
+			{
+				assert(m_state.load(std::memory_order_relaxed) == Ready);
+				return std::move(*m_value);
+			}
+
+		private:
+
+			static constexpr bool is_pooled = ADL_FUTURE_STATE_POOL_CAPACITY > 0 && alignof(value_t) <= alignof(std::max_align_t);
+
+			static void destroy(SharedState* state)
+			{
+				if constexpr (is_pooled)
+				{
+					state->~SharedState();
+					ThreadLocalPool<sizeof(SharedState), ADL_FUTURE_STATE_POOL_CAPACITY>::deallocate(state);
+				}
+				else
+				{
+					delete state;
+				}
+			}
+
+			enum : uint32_t
+			{
+				Empty,
+				// Value is not set yet and there are parked threads
+				Waiting,
+				// Value is not set yet and there is a continuation
+				Continued,
+				Ready,
+				Broken
+			};
+
+			void set_state(uint32_t state)
+			{
+				const uint32_t previous = m_state.exchange(state, std::memory_order_acq_rel);
+
+				// Syscall is made only if somebody is parked
+				if (previous == Waiting)
+				{
+					atomic_notify_all(m_state);
+				}
+				else if (previous == Continued)
+				{
+					post_continuation();
+				}
+			}
+
+			void post_continuation()
+			{
+				// Continuation owns a reference to the state, so it is moved out before the state can be released
+				ExecutionAgent<> continuation = std::move(m_continuation);
+				m_post(std::move(continuation));
+			}
+
+			std::atomic<uint32_t> m_state{ Empty };
+			std::atomic<uint32_t> m_refs{ 1 };
+			std::optional<value_t> m_value;
+			ExecutionAgent<> m_continuation;
+			void (*m_post)(ExecutionAgent<>&&) = nullptr;
+		};
+	}
+
+	// Receiving end of the asynchronous result.
+	// Unlike std::future, ready future holds the value inline and doesn't allocate.
+	template<typename T>
+	class future
+	{
+	public:
+
+		using value_t = void_to_placeholder_t<T>;
+
+		future() = default;
+		future(const future&) = delete;
+		future& operator=(const future&) = delete;
+
+		future(future&& other) noexcept
+			: m_state{ std::exchange(other.m_state, nullptr) }
+			, m_value{ std::move(other.m_value) }
+		{
+			other.m_value.reset();
+		}
+
+		future& operator=(future&& other) noexcept
+		{
+			if (this != &other)
+			{
+				reset();
+				m_state = std::exchange(other.m_state, nullptr);
+				m_value = std::move(other.m_value);
+				other.m_value.reset();
+			}
+
+			return *this;
+		}
+
+		~future()
+		{
+			reset();
+		}
+
+		bool valid() const
+		{
+			return m_state != nullptr || m_value.has_value();
+		}
+
+		bool is_ready() const
+		{
+			assert(valid());
+			return m_value.has_value() || m_state->is_ready();
+		}
+
+		void wait() const
+		{
+			assert(valid());
+
+			if (m_state != nullptr)
+			{
+				m_state->wait();
+			}
+		}
+
+		// Wait for the result and return it, future is not valid after the call.
+		// Throws std::future_error with broken_promise if the promise was destroyed without setting the value.
+		T get()
+		{
+			if constexpr (std::is_void_v<T>)
+			{
+				take();
+			}
+			else
+			{
+				return take();
+			}
+		}
+
+		// Post continuation to the channel when the result is ready, the thread is not blocked.
+		// Continuation is invoked with the result and its own result is passed to the returned future,
+		// if promise is broken then continuation is not invoked and the returned future is broken too.
+		template<typename ChannelType, typename F>
+		auto then(F&& callable)
+		{
+			assert(valid());
+
+			using callable_t = std::decay_t<F>;
+			using invoke_result_t = result_of_ignoring_placeholder_t<callable_t&, value_t>;
+			using result_t = std::conditional_t<is_placeholder_v<invoke_result_t>, void, invoke_result_t>;
+
+			promise<result_t> continuationPromise;
+			future<result_t> continuationFuture = continuationPromise.get_future();
+
+			details::SharedState<T>* state = m_state;
+
+			// Continuation takes over the future, so the shared state is kept alive until it's executed
+			ExecutionAgent<> continuation{ [self = std::move(*this), promise = std::move(continuationPromise), callable = callable_t(std::forward<F>(callable))]() mutable
+			{
+				if (!self.is_broken())
+				{
+					promise.set_value(invoke_ignoring_placeholder(callable, self.take()));
+				}
+			} };
+
+			if (state != nullptr)
+			{
+				state->set_continuation(std::move(continuation), &post_continuation<ChannelType>);
+			}
+			else
+			{
+				post<ChannelType>(std::move(continuation));
+			}
+
+			return continuationFuture;
+		}
+
+	private:
+
+		template<typename ChannelType>
+		static void post_continuation(ExecutionAgent<>&& continuation)
+		{
+			post<ChannelType>(std::move(continuation));
+		}
+
+		template<typename U>
+		friend class promise;
+
+		template<typename U>
+		friend future<std::decay_t<U>> make_ready_future(U&& value);
+
+		friend future<void> make_ready_future();
+
+		explicit future(details::SharedState<T>* state)
+			: m_state{ state }
+		{}
+
+		template<typename U>
+		future(std::in_place_t, U&& value)
+			: m_value{ std::in_place, std::forward<U>(value) }
+		{}
+
+		bool is_broken() const
+		{
+			return m_state != nullptr && m_state->is_broken();
+		}
+
+		value_t take()
+		{
+			assert(valid());
+
+			if (!m_value.has_value())
+			{
+				m_state->wait();
+
+				// Promise was destroyed without setting the value, the future isn't valid after the error like std::future
+				if (m_state->is_broken())
+				{
+					reset();
+					throw std::future_error{ std::future_errc::broken_promise };
+				}
+			}
+
+			value_t value = m_value.has_value() ? std::move(*m_value) : m_state->get();
+			reset();
+
+			return value;
+		}
+
+		void reset()
+		{
+			if (m_state != nullptr)
+			{
+				std::exchange(m_state, nullptr)->release();
+			}
+
+			m_value.reset();
+		}
+
+		details::SharedState<T>* m_state = nullptr;
+		std::optional<value_t> m_value;
+	};
+
+	// Sending end of the asynchronous result
+	template<typename T>
+	class promise
+	{
+	public:
+
+		promise()
+			: m_state{ details::SharedState<T>::create() }
+		{}
+
+		promise(const promise&) = delete;
+		promise& operator=(const promise&) = delete;
+
+		promise(promise&& other) noexcept
+			: m_state{ std::exchange(other.m_state, nullptr) }
+			, m_satisfied{ other.m_satisfied }
+		{}
+
+		promise& operator=(promise&& other) noexcept
+		{
+			if (this != &other)
+			{
+				reset();
+				m_state = std::exchange(other.m_state, nullptr);
+				m_satisfied = other.m_satisfied;
+			}
+
+			return *this;
+		}
+
+		~promise()
+		{
+			reset();
+		}
+
+		// Should be called once
+		future<T> get_future()
+		{
+			m_state->add_ref();
+			return future<T>{ m_state };
+		}
+
+		template<typename... Args>
+		void set_value(Args&&... args)
+		{
+			assert(!m_satisfied);
+			m_state->set_value(std::forward<Args>(args)...);
+			m_satisfied = true;
+		}
+
+	private:
+
+		void reset()
+		{
+			if (m_state != nullptr)
+			{
+				if (!m_satisfied)
+				{
+					m_state->set_broken();
+				}
+
+				std::exchange(m_state, nullptr)->release();
+			}
+		}
+
+		details::SharedState<T>* m_state = nullptr;
+		bool m_satisfied = false;
+	};
+
+	// Make a future which holds the value without shared state allocation
+	template<typename T>
+	future<std::decay_t<T>> make_ready_future(T&& value)
+	{
+		return future<std::decay_t<T>>{ std::in_place, std::forward<T>(value) };
+	}
+
+	inline future<void> make_ready_future()
+	{
+		return future<void>{ std::in_place, placeholder{} };
+	}
+}
\ No newline at end of file
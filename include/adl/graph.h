@@ -0,0 +1,312 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include "atomic_wait.h"
+#include "dispatcher.h"
+#include "priority.h"
+#include "executors/execution_agent.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace adl
+{
+	// Static graph of tasks bound to channels. Graph is compiled once and launched repeatedly,
+	// every node is executed once per launch after all of its predecessors are completed.
+	// Launch doesn't allocate, nodes made ready by the same node are posted to their channel in bulks, one agent per node.
+	class graph
+	{
+	public:
+
+		using node_id = uint32_t;
+
+		graph() = default;
+		graph(const graph&) = delete;
+		graph& operator=(const graph&) = delete;
+
+		// Launched graph should be completed before it's destroyed, see done()
+		~graph()
+		{
+			assert(done());
+		}
+
+		// Add node which invokes the callable in provided channel on every launch
+		template<typename ChannelType, typename F>
+		node_id node(F&& callable)
+		{
+			assert(done());
+
+			m_compiled = false;
+			m_nodes.push_back({ &post_ready<ChannelType>, ExecutionAgent<>{ std::forward<F>(callable) } });
+
+			return static_cast<node_id>(m_nodes.size() - 1);
+		}
+
+		// Node after is executed when node before is completed
+		void precede(node_id before, node_id after)
+		{
+			assert(done());
+			assert(before < m_nodes.size() && after < m_nodes.size());
+
+			m_compiled = false;
+			m_edges.emplace_back(before, after);
+		}
+
+		// Build successor lists and predecessor counts, returns false if the graph has a cycle.
+		// Graph is compiled by the first launch if it's not compiled explicitly.
+		bool compile()
+		{
+			assert(done());
+
+			const node_id nodes = static_cast<node_id>(m_nodes.size());
+			const node_id source = nodes;
+
+			// Nodes without predecessors are successors of the virtual source node, which is released by the launch
+			m_predecessors.assign(nodes, 0);
+
+			for (auto&& [before, after] : m_edges)
+			{
+				++m_predecessors[after];
+			}
+
+			std::vector<std::pair<node_id, node_id>> edges{ m_edges };
+
+			for (node_id id = 0; id < nodes; ++id)
+			{
+				if (m_predecessors[id] == 0)
+				{
+					edges.emplace_back(source, id);
+					m_predecessors[id] = 1;
+				}
+			}
+
+			// Successors are grouped by the post function, so the ready ones are posted to each channel at once
+			std::stable_sort(edges.begin(), edges.end(), [this](const auto& lhs, const auto& rhs)
+			{
+				return lhs.first != rhs.first ? lhs.first < rhs.first : std::less<>{}(m_nodes[lhs.second].post, m_nodes[rhs.second].post);
+			});
+
+			m_offsets.assign(nodes + 2, 0);
+			m_successors.resize(edges.size());
+
+			for (auto&& [before, after] : edges)
+			{
+				++m_offsets[before + 1];
+			}
+
+			for (node_id id = 0; id <= nodes; ++id)
+			{
+				m_offsets[id + 1] += m_offsets[id];
+			}
+
+			for (size_t i = 0; i < edges.size(); ++i)
+			{
+				m_successors[i] = edges[i].second;
+			}
+
+			if (has_cycle())
+			{
+				return false;
+			}
+
+			m_counters = std::make_unique<std::atomic<uint32_t>[]>(nodes);
+			m_ready = std::make_unique<node_id[]>(m_successors.size());
+			m_compiled = true;
+
+			return true;
+		}
+
+		// Post the nodes without predecessors with priority of the current agent, the previous launch should be completed
+		void launch()
+		{
+			assert(done());
+
+			if (!m_compiled && !compile())
+			{
+				assert(false && "Graph has a cycle");
+				return;
+			}
+
+			const node_id nodes = static_cast<node_id>(m_nodes.size());
+
+			if (nodes == 0)
+			{
+				return;
+			}
+
+			for (node_id id = 0; id < nodes; ++id)
+			{
+				m_counters[id].store(m_predecessors[id], std::memory_order_relaxed);
+			}
+
+			m_priority = details::current_priority();
+			m_completed.store(false, std::memory_order_relaxed);
+			m_remaining.store(nodes, std::memory_order_release);
+
+			release_successors(nodes);
+		}
+
+		// Returns true if all nodes of the last launch are completed and the graph isn't touched by their agents anymore
+		bool done() const
+		{
+			return m_completed.load(std::memory_order_acquire);
+		}
+
+		// Block the thread until all nodes of the last launch are completed, the nodes shouldn't be dispatched by this thread
+		void wait()
+		{
+			uint32_t remaining = m_remaining.load(std::memory_order_acquire);
+
+			while (remaining != 0)
+			{
+				details::atomic_wait(m_remaining, remaining);
+				remaining = m_remaining.load(std::memory_order_acquire);
+			}
+
+			// Completion is published right after the notification
+			while (!done())
+			{
+				details::cpu_relax();
+			}
+		}
+
+		size_t size() const
+		{
+			return m_nodes.size();
+		}
+
+	private:
+
+		// Posts ready nodes to the channel of the node
+		using post_ready_t = void (*)(graph& self, const node_id* ready, uint32_t count);
+
+		struct Node
+		{
+			post_ready_t post;
+			ExecutionAgent<> agent;
+		};
+
+		// Number of agents posted to the channel at once
+		static constexpr uint32_t POST_BULK = 4;
+
+		// Every ready node is a separate agent, so the nodes posted together can be executed in parallel
+		template<typename ChannelType>
+		static void post_ready(graph& self, const node_id* ready, uint32_t count)
+		{
+			details::PriorityScope priorityScope{ self.m_priority };
+
+			auto agent = [&self](node_id id) { return [&self, id] { self.run(id); }; };
+
+			uint32_t i = 0;
+
+			for (; i + POST_BULK <= count; i += POST_BULK)
+			{
+				post_bulk<ChannelType>(agent(ready[i]), agent(ready[i + 1]), agent(ready[i + 2]), agent(ready[i + 3]));
+			}
+
+			switch (count - i)
+			{
+			case 3:
+				post_bulk<ChannelType>(agent(ready[i]), agent(ready[i + 1]), agent(ready[i + 2]));
+				break;
+			case 2:
+				post_bulk<ChannelType>(agent(ready[i]), agent(ready[i + 1]));
+				break;
+			case 1:
+				post<ChannelType>(agent(ready[i]));
+				break;
+			default:
+				break;
+			}
+		}
+
+		// Kahn's algorithm on the compiled successor lists
+		bool has_cycle() const
+		{
+			const node_id nodes = static_cast<node_id>(m_nodes.size());
+
+			std::vector<uint32_t> predecessors{ m_predecessors };
+			std::vector<node_id> ready{ nodes };
+			size_t visited = 0;
+
+			while (!ready.empty())
+			{
+				const node_id id = ready.back();
+				ready.pop_back();
+				++visited;
+
+				for (uint32_t i = m_offsets[id]; i != m_offsets[id + 1]; ++i)
+				{
+					if (--predecessors[m_successors[i]] == 0)
+					{
+						ready.push_back(m_successors[i]);
+					}
+				}
+			}
+
+			// Source node is visited as well
+			return visited != nodes + size_t{ 1 };
+		}
+
+		// Decrement counters of the successors and post the ready ones, grouped by channel.
+		// Ready nodes are written to the scratch range of the completed node, which isn't used by other nodes.
+		void release_successors(node_id id)
+		{
+			const uint32_t end = m_offsets[id + 1];
+
+			for (uint32_t begin = m_offsets[id]; begin != end; )
+			{
+				auto* post = m_nodes[m_successors[begin]].post;
+				uint32_t ready = begin;
+				uint32_t i = begin;
+
+				for (; i != end && m_nodes[m_successors[i]].post == post; ++i)
+				{
+					if (m_counters[m_successors[i]].fetch_sub(1, std::memory_order_acq_rel) == 1)
+					{
+						m_ready[ready++] = m_successors[i];
+					}
+				}
+
+				if (ready != begin)
+				{
+					post(*this, &m_ready[begin], ready - begin);
+				}
+
+				begin = i;
+			}
+		}
+
+		void run(node_id id)
+		{
+			m_nodes[id].agent();
+			release_successors(id);
+
+			// Waiters are woken by the last node, completion is published after that and the graph isn't touched anymore
+			if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				details::atomic_notify_all(m_remaining);
+				m_completed.store(true, std::memory_order_release);
+			}
+		}
+
+		std::vector<Node> m_nodes;
+		std::vector<std::pair<node_id, node_id>> m_edges;
+		// Compiled successor lists, the last one belongs to the virtual source node
+		std::vector<uint32_t> m_offsets;
+		std::vector<node_id> m_successors;
+		std::vector<uint32_t> m_predecessors;
+		std::unique_ptr<std::atomic<uint32_t>[]> m_counters;
+		std::unique_ptr<node_id[]> m_ready;
+		std::atomic<uint32_t> m_remaining{ 0 };
+		std::atomic_bool m_completed{ true };
+		Priority m_priority = Priority::Normal;
+		bool m_compiled = false;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace adl
+{
+	// Priority of the execution agent, executors without priorities ignore it
+	enum class Priority : uint8_t
+	{
+		Low,
+		Normal,
+		High,
+		Critical
+	};
+
+	inline constexpr size_t PRIORITY_LEVELS = static_cast<size_t>(Priority::Critical) + 1;
+
+	namespace details
+	{
+		// Priority of the execution agent invoked by the current thread, agents posted without priority inherit it
+		inline Priority& current_priority()
+		{
+			static thread_local Priority priority = Priority::Normal;
+			return priority;
+		}
+
+		// Set the current priority until destroyed
+		class PriorityScope
+		{
+		public:
+
+			explicit PriorityScope(Priority priority)
+				: m_previous{ current_priority() }
+			{
+				current_priority() = priority;
+			}
+
+			PriorityScope(const PriorityScope&) = delete;
+			PriorityScope& operator=(const PriorityScope&) = delete;
+
+			~PriorityScope()
+			{
+				current_priority() = m_previous;
+			}
+
+		private:
+
+			const Priority m_previous;
+		};
+	}
+}
\ No newline at end of file
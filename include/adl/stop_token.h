@@ -0,0 +1,224 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#if defined(__cpp_lib_jthread)
+#include <stop_token>
+#endif
+
+namespace adl
+{
+	#if defined(__cpp_lib_jthread)
+
+	// Standard stop tokens are used when they are available, so tokens of std::jthread can be passed directly
+	using std::stop_token;
+	using std::stop_source;
+	using std::stop_callback;
+
+	#else
+
+	namespace details
+	{
+		// Intrusive node of the registered stop callback
+		struct StopCallbackNode
+		{
+			void (*invoke)(StopCallbackNode*) = nullptr;
+			StopCallbackNode* prev = nullptr;
+			StopCallbackNode* next = nullptr;
+		};
+
+		class StopState
+		{
+		public:
+
+			bool stop_requested() const
+			{
+				return m_stopped.load(std::memory_order_acquire);
+			}
+
+			// Callbacks are invoked by the thread which requested the stop
+			bool request_stop()
+			{
+				std::unique_lock lock{ m_mutex };
+
+				if (m_stopped.exchange(true, std::memory_order_acq_rel))
+				{
+					return false;
+				}
+
+				while (m_callbacks != nullptr)
+				{
+					StopCallbackNode* callback = m_callbacks;
+					remove(callback);
+					callback->invoke(callback);
+				}
+
+				return true;
+			}
+
+			// Callback is invoked immediately if the stop is already requested
+			void add(StopCallbackNode* callback)
+			{
+				std::unique_lock lock{ m_mutex };
+
+				if (m_stopped.load(std::memory_order_relaxed))
+				{
+					callback->invoke(callback);
+					return;
+				}
+
+				callback->next = m_callbacks;
+
+				if (m_callbacks != nullptr)
+				{
+					m_callbacks->prev = callback;
+				}
+
+				m_callbacks = callback;
+			}
+
+			// Waits for the callback if it is being invoked by other thread
+			void erase(StopCallbackNode* callback)
+			{
+				std::unique_lock lock{ m_mutex };
+
+				if (callback->prev != nullptr || m_callbacks == callback)
+				{
+					remove(callback);
+				}
+			}
+
+		private:
+
+			void remove(StopCallbackNode* callback)
+			{
+				if (callback->prev != nullptr)
+				{
+					callback->prev->next = callback->next;
+				}
+				else
+				{
+					m_callbacks = callback->next;
+				}
+
+				if (callback->next != nullptr)
+				{
+					callback->next->prev = callback->prev;
+				}
+
+				callback->prev = nullptr;
+				callback->next = nullptr;
+			}
+
+			std::atomic_bool m_stopped{ false };
+			std::mutex m_mutex;
+			StopCallbackNode* m_callbacks = nullptr;
+		};
+	}
+
+	// Subset of std::stop_token for C++17, default constructed token is never stopped
+	class stop_token
+	{
+	public:
+
+		stop_token() = default;
+
+		bool stop_requested() const noexcept
+		{
+			return m_state && m_state->stop_requested();
+		}
+
+		bool stop_possible() const noexcept
+		{
+			return m_state != nullptr;
+		}
+
+	private:
+
+		friend class stop_source;
+
+		template<typename Callback>
+		friend class stop_callback;
+
+		explicit stop_token(std::shared_ptr<details::StopState> state)
+			: m_state{ std::move(state) }
+		{}
+
+		std::shared_ptr<details::StopState> m_state;
+	};
+
+	class stop_source
+	{
+	public:
+
+		stop_source()
+			: m_state{ std::make_shared<details::StopState>() }
+		{}
+
+		stop_token get_token() const noexcept
+		{
+			return stop_token{ m_state };
+		}
+
+		bool stop_requested() const noexcept
+		{
+			return m_state->stop_requested();
+		}
+
+		// Returns false if the stop is already requested
+		bool request_stop()
+		{
+			return m_state->request_stop();
+		}
+
+	private:
+
+		std::shared_ptr<details::StopState> m_state;
+	};
+
+	// Invokes callback when the stop is requested, or immediately if it is already requested
+	template<typename Callback>
+	class stop_callback : private details::StopCallbackNode
+	{
+	public:
+
+		template<typename C>
+		explicit stop_callback(const stop_token& token, C&& callback)
+			: m_state{ token.m_state }
+			, m_callback{ std::forward<C>(callback) }
+		{
+			if (m_state)
+			{
+				invoke = [](details::StopCallbackNode* node) { static_cast<stop_callback*>(node)->m_callback(); };
+				m_state->add(this);
+			}
+		}
+
+		stop_callback(const stop_callback&) = delete;
+		stop_callback& operator=(const stop_callback&) = delete;
+
+		~stop_callback()
+		{
+			if (m_state)
+			{
+				m_state->erase(this);
+			}
+		}
+
+	private:
+
+		std::shared_ptr<details::StopState> m_state;
+		Callback m_callback;
+	};
+
+	template<typename Callback>
+	stop_callback(stop_token, Callback) -> stop_callback<Callback>;
+
+	#endif
+}
\ No newline at end of file
@@ -3,17 +3,20 @@
 
 #pragma once
 #include "dispatcher.h"
+#include "event.h"
 #include "execution_context.h"
+#include "timers.h"
 
 namespace adl {
 
-	template<typename ChannelType, typename CallableType, typename ContinuationType>
+	// ArgType is the result of the previous execution agent which is passed to the continuation
+	template<typename ChannelType, typename CallableType, typename ContinuationType, typename ArgType = void>
 	class TaskWrapper;
 
 	template<typename ChannelType, typename CallableType>
 	constexpr auto task(CallableType&& callable);
 
-	template<typename ChannelType, typename CallableType, typename ContinuationType>
+	template<typename ChannelType, typename ArgType, typename CallableType, typename ContinuationType>
 	constexpr auto continuationTask(CallableType&& callable, ContinuationType&& continuation);
 
 	namespace details
@@ -22,13 +25,32 @@ namespace adl {
 		struct task_wrapper_traits : std::false_type
 		{};
 
-		template<typename ChannelType, typename CallableType, typename ContinuationType>
-		struct task_wrapper_traits<TaskWrapper<ChannelType, CallableType, ContinuationType>> : std::true_type
+		template<typename ChannelType, typename CallableType, typename ContinuationType, typename ArgType>
+		struct task_wrapper_traits<TaskWrapper<ChannelType, CallableType, ContinuationType, ArgType>> : std::true_type
 		{};
 
 		template<typename T>
 		inline constexpr bool is_task_wrapper_v = task_wrapper_traits<std::decay_t<T>>::value;
 
+		// Result of the last execution agent of the task, void results are replaced with placeholder
+		template<typename T>
+		struct task_result;
+
+		template<typename ChannelType, typename CallableType>
+		struct task_result<TaskWrapper<ChannelType, CallableType, void, void>>
+		{
+			using type = result_of_unwrap_execution_result_t<result_of_invoke_with_context_t<CallableType&>>;
+		};
+
+		template<typename ChannelType, typename CallableType, typename ContinuationType, typename ArgType>
+		struct task_result<TaskWrapper<ChannelType, CallableType, ContinuationType, ArgType>>
+		{
+			using type = result_of_unwrap_execution_result_t<result_of_invoke_with_context_t<ContinuationType&, ArgType>>;
+		};
+
+		template<typename T>
+		using task_result_t = typename task_result<std::decay_t<T>>::type;
+
 		template<typename T>
 		constexpr auto unwrap(T&& callable)
 		{
@@ -42,11 +64,161 @@ namespace adl {
 			}
 		}
 
+		// Timed and event deferrals park the wrapper once, so it isn't posted to the defer channel again and again
+		template<typename DeferChannel, typename T, typename WrapperType>
+		void defer_execution(ResultWithContext<T>& result, WrapperType&& wrapper)
+		{
+			const ExecutionContext& context = result.context;
+
+			if (context.is_deferred_until())
+			{
+				context.deferred_event().template post_when_set<DeferChannel>(std::forward<WrapperType>(wrapper));
+			}
+			else if (context.is_deferred_for())
+			{
+				post_at<DeferChannel>(context.deadline(), std::forward<WrapperType>(wrapper));
+			}
+			else
+			{
+				post_defer<DeferChannel>(std::forward<WrapperType>(wrapper));
+			}
+		}
+
+		template<typename DeferChannel, typename T, typename WrapperType>
+		void defer_execution(T&&, WrapperType&& wrapper)
+		{
+			post_defer<DeferChannel>(std::forward<WrapperType>(wrapper));
+		}
+
+		// Same-channel hop is elided by invoking the continuation inline, real hop always posts it
+		template<typename ContinuationChannel, bool InlineHop, typename F>
+		void post_continuation(F&& continuation)
+		{
+			if constexpr (InlineHop)
+			{
+				post_or_invoke<ContinuationChannel>(std::forward<F>(continuation));
+			}
+			else
+			{
+				post<ContinuationChannel>(std::forward<F>(continuation));
+			}
+		}
+
+		// Invoke the first execution agent of the node and post its result with continuation to the continuation channel
+		template<typename DeferChannel, typename ContinuationChannel, typename CallableType, typename ContinuationType, bool InlineHop = true>
+		struct ExecutionWrapper
+		{
+			CallableType		callable;
+			ContinuationType	continuation;
+			// Continuations inherit the priority of the agent which created the wrapper
+			Priority			priority = current_priority();
+
+			inline constexpr void operator()()
+			{
+				PriorityScope priorityScope{ priority };
+
+				auto result = details::try_invoke_with_context(callable);
+
+				// if result with context this code will check if continuation was canceled.
+				// if result without context this code will be thrown away by compiler since in this case is_execution_canceled always return false
+				if (details::is_execution_canceled(result))
+				{
+					return;
+				}
+
+				// if result with context this code will check if continuation was deferred.
+				// if result without context this code will be thrown away by compiler since in this case is_execution_deferred always return false
+				if (details::is_execution_deferred(result))
+				{
+					// Defer current task
+					defer_execution<DeferChannel>(result, ExecutionWrapper{ std::move(callable), std::move(continuation) });
+
+					return;
+				}
+
+				// Post continuation to the specified channel so it will be invoked by channel executor,
+				// same-channel continuation is invoked inline unless it requires a real hop
+				post_continuation<ContinuationChannel, InlineHop>([result = details::unwrap_execution_result(std::move(result)), continuation = std::move(continuation), priority = current_priority()]()
+				{
+					PriorityScope priorityScope{ priority };
+
+					// Captured variables here:
+					// 'result' - result of the previous execution agent or a placeholder (if previous execution returned void)
+					// 'continuation' - can be a node or last execution agent passed to the task
+
+					// If continuation is a node, we should always pass the result to it, since it can't be ignored.
+					// If this is an execution agent, we should pass the result only if it can be invoked with it.
+					// For example last leaf can be a function with no arguments, and in this case result is discarded. 
+					// #TODO: need a better way to find out if continuation is a node or execution agent
+					try_invoke_with_arg(continuation, std::move(result));
+				});
+			}
+		};
+
+		// Invoke execution agent with the result of the previous one and post its result with continuation to the continuation channel
+		template<typename DeferChannel, typename ContinuationChannel, typename CallableType, typename ContinuationType, typename ResultRefType, bool InlineHop = true>
+		struct ContinuationExecutionWrapper
+		{
+			CallableType							callable;
+			ContinuationType						continuation;
+			std::remove_reference_t<ResultRefType>	prevResult;
+			Priority								priority = current_priority();
+
+			inline constexpr void operator()()
+			{
+				PriorityScope priorityScope{ priority };
+				invoke(std::move(callable), std::move(continuation), std::move(prevResult));
+			}
+
+			static inline constexpr void invoke(CallableType callable, ContinuationType continuation, ResultRefType prevResult)
+			{
+				// Result shouldn't be moved if callable is invokable with context
+				// It is possible that execution will be deferred and prev result will be reused in call of the deferred task
+				// This imposes restrictions to the callable signature, - smth like 'void foo(ExecutionContext&, T&&)' is prohibited, second argument can't be rvalue
+				auto result = details::try_invoke_with_context(callable, details::move_if_invokable_without_context<CallableType>(prevResult));
+
+				// if result with context this code will check if continuation was canceled.
+				// if result without context this code will be thrown away by compiler since in this case is_execution_canceled always return false
+				if (details::is_execution_canceled(result))
+				{
+					return;
+				}
+
+				// if result with context this code will check if continuation was deferred and post a new deferred call.
+				// if result without context this code will be thrown away by compiler since in this case is_execution_deferred always return false
+				if (details::is_execution_deferred(result))
+				{
+					// Defer current task, previous result is kept by the wrapper until it is invoked again
+					defer_execution<DeferChannel>(result, ContinuationExecutionWrapper{ std::move(callable), std::move(continuation), std::move(prevResult) });
+
+					return;
+				}
+
+				// Post continuation to the specified channel so it will be invoked by channel executor,
+				// same-channel continuation is invoked inline unless it requires a real hop
+				post_continuation<ContinuationChannel, InlineHop>([result = details::unwrap_execution_result(std::move(result)), continuation = std::move(continuation), priority = current_priority()]()
+				{
+					PriorityScope priorityScope{ priority };
+
+					// Captured variables here:
+					// 'result' - result of the previous execution agent or a placeholder (if previous execution returned void)
+					// 'continuation' - can be a node or last execution agent passed to the task
+
+					// If continuation is a node, we should always pass the result to it. See argument (auto&& prevResult) in TaskWrapper::then, it can't be ignored.
+					// So if the result is placeholder, it will be ignored during continuation invoke.
+					// If this is an execution agent, we should pass the result only if it can be invoked with it.
+					// For example last leaf can be a function with no arguments, and in this case result is discarded. 
+					// #TODO: need a better way to find out if continuation is a node or execution agent
+					try_invoke_with_arg(continuation, std::move(result));
+				});
+			}
+		};
+
 	} // namespace detail
 
 	// Task without continuation
 	template<typename ChannelType, typename CallableType>
-	class TaskWrapper<ChannelType, CallableType, void>
+	class TaskWrapper<ChannelType, CallableType, void, void>
 	{
 	public:
 
@@ -168,68 +340,18 @@ namespace adl {
 			});
 		}
 
-		// Execute continuation in specified channel
+		// Execute continuation in specified channel, it is invoked inline if the callable is already executed by this channel
 		template<typename ContinuationChannel, typename F>
 		constexpr auto then(F&& thenExecutionAgent)
 		{
-			// Create a new node with continuation
-			return continuationTask<ContinuationChannel>([callable = std::move(m_callable)](auto&& inputContinuation)
-			{
-				// Variables here:
-				// 'callable' - can be a first execution agent or a 'strand' node with execution agents
-				// 'inputContinuation' - can be a next continuation node or last execution agent passed to then
-
-				using ExCallableRef = decltype(callable);
-				using ExContinuationRef = decltype(inputContinuation);
-				using ExContinuationChannel = ContinuationChannel;
-				using ExDeferChannel = channel_t;
-
-				struct ExecutionWrapper
-				{
-					std::remove_reference_t<ExCallableRef> callable;
-					std::remove_reference_t<ExContinuationRef> continuation;
-
-					inline constexpr void operator()()
-					{
-						auto result = details::try_invoke_with_context(callable);
-
-						// if result with context this code will check if continuation was canceled.
-						// if result without context this code will be thrown away by compiler since in this case is_execution_canceled always return false
-						if (details::is_execution_canceled(result))
-						{
-							return;
-						}
-
-						// if result with context this code will check if continuation was deferred.
-						// if result without context this code will be thrown away by compiler since in this case is_execution_deferred always return false
-						if (details::is_execution_deferred(result))
-						{
-							// Defer current task
-							adl::post_defer<ExDeferChannel>(ExecutionWrapper{ std::move(callable), std::move(continuation) });
-
-							return;
-						}
-
-						// Post continuation to the specified channel so it will be invoked by channel executor
-						adl::post<ExContinuationChannel>([result = details::unwrap_execution_result(std::move(result)), continuation = std::move(continuation)]()
-						{
-							// Captured variables here:
-							// 'result' - result of the previous execution agent or a placeholder (if previous execution returned void)
-							// 'continuation' - can be a node or last execution agent passed to the task
-
-							// If continuation is a node, we should always pass the result to it, since it can't be ignored.
-							// If this is an execution agent, we should pass the result only if it can be invoked with it.
-							// For example last leaf can be a function with no arguments, and in this case result is discarded. 
-							// #TODO: need a better way to find out if continuation is a node or execution agent
-							try_invoke_with_arg(continuation, std::move(result));
-						});
-					}
-				};
-
-				adl::post<channel_t>(ExecutionWrapper{ std::move(callable), std::forward<ExContinuationRef>(inputContinuation) });
+			return then_impl<ContinuationChannel, true>(std::forward<F>(thenExecutionAgent));
+		}
 
-			},
-				details::unwrap(std::forward<F>(thenExecutionAgent)));
+		// Execute continuation in specified channel, it is always posted even if the callable is executed by the same channel
+		template<typename ContinuationChannel, typename F>
+		constexpr auto then_post(F&& thenExecutionAgent)
+		{
+			return then_impl<ContinuationChannel, false>(std::forward<F>(thenExecutionAgent));
 		}
 
 		constexpr void submit() &&
@@ -242,6 +364,19 @@ namespace adl {
 			adl::post<channel_t>(m_callable);
 		}
 
+		// Submit with priority, continuations of the task inherit it
+		void submit(Priority priority) &&
+		{
+			details::PriorityScope priorityScope{ priority };
+			std::move(*this).submit();
+		}
+
+		void submit(Priority priority) &
+		{
+			details::PriorityScope priorityScope{ priority };
+			submit();
+		}
+
 		constexpr auto unwrap() &
 		{
 			// If you got this assert, make sure that all execution agents in nested task is copy constructible, or try to use std::move when passing nested task
@@ -255,7 +390,8 @@ namespace adl {
 			{
 				return [callable = m_callable]()
 				{
-					adl::post<channel_t>(std::move(callable));
+					// Nested task is invoked inline if it is unwrapped by the task of the same channel
+					adl::post_or_invoke<channel_t>(std::move(callable));
 				};
 			}
 		}
@@ -270,18 +406,38 @@ namespace adl {
 			{
 				return[callable = std::move(m_callable)]()
 				{
-					adl::post<channel_t>(std::move(callable));
+					// Nested task is invoked inline if it is unwrapped by the task of the same channel
+					adl::post_or_invoke<channel_t>(std::move(callable));
 				};
 			}
 		}
 
 	private:
 
+		template<typename ContinuationChannel, bool InlineHop, typename F>
+		constexpr auto then_impl(F&& thenExecutionAgent)
+		{
+			// Create a new node with continuation
+			return continuationTask<ContinuationChannel, details::task_result_t<TaskWrapper>>([callable = std::move(m_callable)](auto&& inputContinuation)
+			{
+				// Variables here:
+				// 'callable' - can be a first execution agent or a 'strand' node with execution agents
+				// 'inputContinuation' - can be a next continuation node or last execution agent passed to then
+
+				using ExContinuationRef = decltype(inputContinuation);
+				using ExecutionWrapper = details::ExecutionWrapper<channel_t, ContinuationChannel, std::decay_t<decltype(callable)>, std::decay_t<ExContinuationRef>, InlineHop>;
+
+				adl::post<channel_t>(ExecutionWrapper{ std::move(callable), std::forward<ExContinuationRef>(inputContinuation) });
+
+			},
+				details::unwrap(std::forward<F>(thenExecutionAgent)));
+		}
+
 		callable_t m_callable;
 	};
 
 	// Task with continuation
-	template<typename ChannelType, typename CallableType, typename ContinuationType>
+	template<typename ChannelType, typename CallableType, typename ContinuationType, typename ArgType>
 	class TaskWrapper
 	{
 	public:
@@ -352,89 +508,20 @@ namespace adl {
 			return then<void>(std::forward<F>(thenExecutionAgent));
 		}
 
-		// Execute continuation agent in specified channel with result of the previous execution agent
+		// Execute continuation agent in specified channel with result of the previous execution agent,
+		// it is invoked inline if the previous execution agent is already executed by this channel
 		template<typename ContinuationChannel, typename F>
 		constexpr auto then(F&& thenExecutionAgent)
 		{
-			// Create a new node with continuation
-			return continuationTask<ContinuationChannel>([callable = std::move(m_callable), continuation = std::move(m_continuation)](auto&& inputContinuation)
-			{
-				// Variables here:
-				// 'callable' - is always a node that accept input continuation
-				// 'continuation' - is always execution agent
-				// 'inputContinuation' - can be a next continuation node or last execution agent passed to then
-
-				// Invoke a node and pass input continuation to it
-				return callable([callable = std::move(continuation), continuation = std::forward<decltype(inputContinuation)>(inputContinuation)](auto&& prevResult)
-				{
-					// Variables here:
-					// 'callable' - is always execution agent
-					// 'continuation' - can be a node or last execution agent passed to the task
-					// 'prevResult' - result of the previous execution agent or a placeholder (if previous execution returned void)
-
-					using ExCallableRef = decltype(callable);
-					using ExContinuationRef = decltype(inputContinuation);
-					using ExContinuation = std::remove_reference_t<ExContinuationRef>;
-					using ExResultRef = decltype(prevResult);
-					using ExContinuationChannel = ContinuationChannel;
-					using ExDeferChannel = channel_t;
-
-					struct ExecutionWrapper
-					{
-						std::remove_reference_t<ExCallableRef>		callable;
-						std::remove_reference_t<ExContinuationRef>	continuation;
-						std::remove_reference_t<ExResultRef>		prevResult;
-
-						inline constexpr void operator()()
-						{
-							invoke(std::move(callable), std::move(continuation), std::move(prevResult));
-						}
-
-						static inline constexpr void invoke(ExCallableRef callable, ExContinuation continuation, ExResultRef prevResult)
-						{
-							// Result shouldn't be moved if callable is invokable with context
-							// It is possible that execution will be deferred and prev result will be reused in call of the deferred task
-							// This imposes restrictions to the callable signature, - smth like 'void foo(ExecutionContext&, T&&)' is prohibited, second argument can't be rvalue
-							auto result = details::try_invoke_with_context(callable, details::move_if_invokable_without_context<ExCallableRef>(prevResult));
-
-							// if result with context this code will check if continuation was canceled.
-							// if result without context this code will be thrown away by compiler since in this case is_execution_canceled always return false
-							if (details::is_execution_canceled(result))
-							{
-								return;
-							}
-
-							// if result with context this code will check if continuation was deferred and post a new deferred call.
-							// if result without context this code will be thrown away by compiler since in this case is_execution_deferred always return false
-							if (details::is_execution_deferred(result))
-							{
-								// Defer current task
-								adl::post_defer<ExDeferChannel>(ExecutionWrapper{ std::move(callable), std::move(continuation), std::move(prevResult) });
-
-								return;
-							}
-
-							// Post continuation to the specified channel so it will be invoked by channel executor
-							adl::post<ExContinuationChannel>([result = details::unwrap_execution_result(std::move(result)), continuation = std::move(continuation)]()
-							{
-								// Captured variables here:
-								// 'result' - result of the previous execution agent or a placeholder (if previous execution returned void)
-								// 'continuation' - can be a node or last execution agent passed to the task
-
-								// If continuation is a node, we should always pass the result to it. See argument (auto&& prevResult) in lambda above, it can't be ignored.
-								// So if the result is placeholder, it will be ignored during continuation invoke.
-								// If this is an execution agent, we should pass the result only if it can be invoked with it.
-								// For example last leaf can be a function with no arguments, and in this case result is discarded. 
-								// #TODO: need a better way to find out if continuation is a node or execution agent
-								try_invoke_with_arg(continuation, std::move(result));
-							});
-						}
-					};
+			return then_impl<ContinuationChannel, true>(std::forward<F>(thenExecutionAgent));
+		}
 
-					ExecutionWrapper::invoke(callable, std::move(continuation), std::forward<ExResultRef>(prevResult));
-				});
-			},
-				details::unwrap(std::forward<F>(thenExecutionAgent)));
+		// Execute continuation agent in specified channel with result of the previous execution agent,
+		// it is always posted even if the previous execution agent is executed by the same channel
+		template<typename ContinuationChannel, typename F>
+		constexpr auto then_post(F&& thenExecutionAgent)
+		{
+			return then_impl<ContinuationChannel, false>(std::forward<F>(thenExecutionAgent));
 		}
 
 		constexpr void submit() &&
@@ -447,6 +534,19 @@ namespace adl {
 			std::invoke(m_callable, m_continuation);
 		}
 
+		// Submit with priority, continuations of the task inherit it
+		void submit(Priority priority) &&
+		{
+			details::PriorityScope priorityScope{ priority };
+			std::move(*this).submit();
+		}
+
+		void submit(Priority priority) &
+		{
+			details::PriorityScope priorityScope{ priority };
+			submit();
+		}
+
 		constexpr auto unwrap() &
 		{
 			// If you got this assert, make sure that all execution agents in nested task is copy constructible, or try to use std::move when passing nested task
@@ -469,6 +569,34 @@ namespace adl {
 
 	private:
 
+		template<typename ContinuationChannel, bool InlineHop, typename F>
+		constexpr auto then_impl(F&& thenExecutionAgent)
+		{
+			// Create a new node with continuation
+			return continuationTask<ContinuationChannel, details::task_result_t<TaskWrapper>>([callable = std::move(m_callable), continuation = std::move(m_continuation)](auto&& inputContinuation)
+			{
+				// Variables here:
+				// 'callable' - is always a node that accept input continuation
+				// 'continuation' - is always execution agent
+				// 'inputContinuation' - can be a next continuation node or last execution agent passed to then
+
+				// Invoke a node and pass input continuation to it
+				return callable([callable = std::move(continuation), continuation = std::forward<decltype(inputContinuation)>(inputContinuation)](auto&& prevResult)
+				{
+					// Variables here:
+					// 'callable' - is always execution agent
+					// 'continuation' - can be a node or last execution agent passed to the task
+					// 'prevResult' - result of the previous execution agent or a placeholder (if previous execution returned void)
+
+					using ExResultRef = decltype(prevResult);
+					using ExecutionWrapper = details::ContinuationExecutionWrapper<channel_t, ContinuationChannel, std::decay_t<decltype(callable)>, std::decay_t<decltype(inputContinuation)>, ExResultRef, InlineHop>;
+
+					ExecutionWrapper::invoke(callable, std::move(continuation), std::forward<ExResultRef>(prevResult));
+				});
+			},
+				details::unwrap(std::forward<F>(thenExecutionAgent)));
+		}
+
 		callable_t		m_callable;
 		continuation_t	m_continuation;
 	};
@@ -487,16 +615,16 @@ namespace adl {
 		return TaskWrapper<ChannelType, UnwrappedCallableType, void>{details::unwrap(std::forward<CallableType>(callable))};
 	}
 
-	template<typename ChannelType, typename CallableType, typename ContinuationType>
+	template<typename ChannelType, typename ArgType, typename CallableType, typename ContinuationType>
 	constexpr auto continuationTask(CallableType&& callable, ContinuationType&& continuation)
 	{
 		using UnwrappedCallableType = decltype(details::unwrap(std::forward<CallableType>(callable)));
 		using UnwrappedContinuationType = decltype(details::unwrap(std::forward<ContinuationType>(continuation)));
-		return TaskWrapper<ChannelType, UnwrappedCallableType, UnwrappedContinuationType>
+		return TaskWrapper<ChannelType, UnwrappedCallableType, UnwrappedContinuationType, ArgType>
 		{
 			details::unwrap(std::forward<CallableType>(callable)),
 				details::unwrap(std::forward<ContinuationType>(continuation))
 		};
 	}
 
-} // namespace adl
+} // namespace adl
\ No newline at end of file
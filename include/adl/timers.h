@@ -0,0 +1,104 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include "dispatcher.h"
+#include "executors/timer_executor.h"
+#include <chrono>
+#include <type_traits>
+#include <utility>
+
+namespace adl
+{
+
+namespace details
+{
+	// Set when the process-wide timer executor is destroyed at exit, executors destroyed later don't touch it
+	inline bool timer_executor_destroyed = false;
+}
+
+// Return process-wide timer executor, its thread is started on the first use
+inline TimerExecutor& get_timer_executor()
+{
+	struct Holder
+	{
+		~Holder()
+		{
+			details::timer_executor_destroyed = true;
+		}
+
+		TimerExecutor executor;
+	};
+
+	static Holder holder;
+	return holder.executor;
+}
+
+namespace details
+{
+	// Pending timers of the channel are canceled before its executor is destroyed
+	template<typename ChannelType>
+	void cancel_timers_for()
+	{
+		if (!timer_executor_destroyed)
+		{
+			get_timer_executor().cancel_all(&post_agent<ChannelType>);
+		}
+	}
+
+	// Channel executor can be destroyed while the timer executor is alive, explicitly or by the registry at exit,
+	// so the registry cancels the timers of the channel first and they don't post to the destroyed executor
+	template<typename ChannelType>
+	TimerExecutor& get_timer_executor_for()
+	{
+		// Agents without channel are invoked by the timer thread
+		if constexpr (!std::is_void_v<ChannelType>)
+		{
+			static const bool registered = (executor_storage<ChannelType>.set_destroy_hook(&cancel_timers_for<ChannelType>), true);
+			(void)registered;
+		}
+
+		get_executor<ChannelType>();
+		return get_timer_executor();
+	}
+
+	template<typename Clock, typename Duration>
+	std::chrono::steady_clock::time_point to_steady_time(std::chrono::time_point<Clock, Duration> time)
+	{
+		if constexpr (std::is_same_v<Clock, std::chrono::steady_clock>)
+		{
+			return std::chrono::time_point_cast<std::chrono::steady_clock::duration>(time);
+		}
+		else
+		{
+			return std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(time - Clock::now());
+		}
+	}
+}
+
+// Submit execution agent to provided channel at the time point, returns handle which can cancel it
+template<typename ChannelType, typename Clock, typename Duration, typename CallableType>
+static TimerHandle post_at(std::chrono::time_point<Clock, Duration> time, CallableType&& callable)
+{
+    return details::get_timer_executor_for<ChannelType>().schedule(details::to_steady_time(time), &details::post_agent<ChannelType>, std::forward<CallableType>(callable));
+}
+
+// Submit execution agent to provided channel after the delay, returns handle which can cancel it
+template<typename ChannelType, typename Rep, typename Period, typename CallableType>
+static TimerHandle post_after(std::chrono::duration<Rep, Period> delay, CallableType&& callable)
+{
+    return post_at<ChannelType>(std::chrono::steady_clock::now() + delay, std::forward<CallableType>(callable));
+}
+
+// Submit execution agent to provided channel every period until canceled, the first one is submitted after the period.
+// Periods are measured from the previous deadline, so the delays of the timer thread don't accumulate.
+template<typename ChannelType, typename Rep, typename Period, typename CallableType>
+static TimerHandle post_every(std::chrono::duration<Rep, Period> period, CallableType&& callable)
+{
+    const auto steadyPeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+
+    return details::get_timer_executor_for<ChannelType>().schedule_periodic(std::chrono::steady_clock::now() + steadyPeriod, steadyPeriod,
+        &details::post_agent<ChannelType>, std::forward<CallableType>(callable));
+}
+
+} // namespace adl
\ No newline at end of file
@@ -0,0 +1,203 @@
+// Copyright (c) 2020 Ivan Miasnikov | mailto:ivaneotg@gmail.com
+// MIT License | https://opensource.org/licenses/MIT
+
+#pragma once
+#include "task.h"
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+namespace adl
+{
+	namespace details
+	{
+		// Pass the joined result to the next continuation of the task, it isn't generic, so it's never invoked with execution context
+		template<typename T>
+		struct ForwardResult
+		{
+			T operator()(T result) const
+			{
+				return result;
+			}
+		};
+
+		// Receives the result of the input task, it can't be invoked with execution context, so it's never mistaken for a context agent
+		template<size_t Index, typename StateType>
+		struct JoinSink
+		{
+			using value_t = std::tuple_element_t<Index, typename StateType::results_t>;
+
+			template<typename T = value_t, typename = std::enable_if_t<!is_placeholder_v<T>>>
+			void operator()(value_t result) const
+			{
+				state->template complete<Index>(std::move(result));
+			}
+
+			template<typename T = value_t, typename = std::enable_if_t<is_placeholder_v<T>>>
+			void operator()() const
+			{
+				state->template complete<Index>(placeholder{});
+			}
+
+			StateType* state;
+		};
+
+		// Results and continuation are kept in a single allocation, the last input task posts the continuation
+		template<typename JoinChannel, typename ContinuationType, typename... Results>
+		class WhenAllState
+		{
+		public:
+
+			using results_t = std::tuple<Results...>;
+			using result_t = results_t;
+
+			explicit WhenAllState(ContinuationType&& continuation)
+				: m_continuation{ std::move(continuation) }
+			{}
+
+			template<size_t Index, typename T>
+			void complete(T&& result)
+			{
+				std::get<Index>(m_results).emplace(std::forward<T>(result));
+
+				if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					post_or_invoke<JoinChannel>([state = std::unique_ptr<WhenAllState>{ this }]() mutable
+					{
+						state->invoke(std::index_sequence_for<Results...>{});
+					});
+				}
+			}
+
+		private:
+
+			template<size_t... Indexes>
+			void invoke(std::index_sequence<Indexes...>)
+			{
+				try_invoke_with_arg(m_continuation, results_t{ std::move(*std::get<Indexes>(m_results))... });
+			}
+
+			ContinuationType m_continuation;
+			std::tuple<std::optional<Results>...> m_results;
+			std::atomic_size_t m_remaining{ sizeof...(Results) };
+		};
+
+		// Result of when_any is the result type if all input tasks have the same one, otherwise a variant indexed by the input task
+		template<typename... Results>
+		using when_any_result_t = std::conditional_t<(... && std::is_same_v<std::tuple_element_t<0, std::tuple<Results...>>, Results>),
+			std::tuple_element_t<0, std::tuple<Results...>>, std::variant<Results...>>;
+
+		// Continuation is posted by the first completed input task, the state is released by the last one
+		template<typename JoinChannel, typename ContinuationType, typename... Results>
+		class WhenAnyState
+		{
+		public:
+
+			using results_t = std::tuple<Results...>;
+			using result_t = when_any_result_t<Results...>;
+
+			explicit WhenAnyState(ContinuationType&& continuation)
+				: m_continuation{ std::move(continuation) }
+			{}
+
+			template<size_t Index, typename T>
+			void complete(T&& result)
+			{
+				if (!m_completed.exchange(true, std::memory_order_acq_rel))
+				{
+					post_or_invoke<JoinChannel>([continuation = std::move(m_continuation), result = make_result<Index>(std::forward<T>(result))]() mutable
+					{
+						try_invoke_with_arg(continuation, std::move(result));
+					});
+				}
+
+				if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				{
+					delete this;
+				}
+			}
+
+		private:
+
+			template<size_t Index, typename T>
+			static result_t make_result(T&& result)
+			{
+				if constexpr (std::is_same_v<result_t, std::variant<Results...>>)
+				{
+					return result_t{ std::in_place_index<Index>, std::forward<T>(result) };
+				}
+				else
+				{
+					return std::forward<T>(result);
+				}
+			}
+
+			ContinuationType m_continuation;
+			std::atomic_bool m_completed{ false };
+			std::atomic_size_t m_remaining{ sizeof...(Results) };
+		};
+
+		// First node of the joined task, it submits the input tasks when the task is submitted. Input tasks are move-only,
+		// so the joined task can be submitted once. Task chain invokes its nodes as const, so the node takes the input tasks
+		// out of the optional and a second submit is caught by the assert instead of submitting moved-from tasks.
+		template<template<typename, typename, typename...> class StateType, typename JoinChannel, typename... Tasks>
+		struct JoinNode
+		{
+			template<typename ContinuationType>
+			void operator()(ContinuationType&& continuation) const
+			{
+				assert(tasks.has_value() && "Joined task can be submitted only once");
+
+				std::tuple<Tasks...> inputs = std::move(*tasks);
+				tasks.reset();
+
+				using state_t = StateType<JoinChannel, std::decay_t<ContinuationType>, task_result_t<Tasks>...>;
+
+				auto* state = new state_t{ std::decay_t<ContinuationType>{ std::forward<ContinuationType>(continuation) } };
+				submit(state, std::move(inputs), std::index_sequence_for<Tasks...>{});
+			}
+
+			template<typename State, size_t... Indexes>
+			static void submit(State* state, std::tuple<Tasks...>&& inputs, std::index_sequence<Indexes...>)
+			{
+				(..., std::move(std::get<Indexes>(inputs)).then(JoinSink<Indexes, State>{ state }).submit());
+			}
+
+			mutable std::optional<std::tuple<Tasks...>> tasks;
+		};
+
+		template<template<typename, typename, typename...> class StateType, typename JoinChannel, typename... Tasks>
+		auto join(Tasks&&... tasks)
+		{
+			static_assert(sizeof...(Tasks) > 0, "At least one task should be joined");
+			static_assert((... && is_task_wrapper_v<Tasks>), "Only tasks can be joined");
+
+			using node_t = JoinNode<StateType, JoinChannel, std::decay_t<Tasks>...>;
+			using result_t = typename StateType<JoinChannel, placeholder, task_result_t<Tasks>...>::result_t;
+
+			return continuationTask<JoinChannel, result_t>(node_t{ std::tuple<std::decay_t<Tasks>...>{ std::forward<Tasks>(tasks)... } }, ForwardResult<result_t>{});
+		}
+	}
+
+	// Submit the tasks to their channels and pass the tuple of their results to the continuation in the join channel.
+	// Results of void tasks are placeholders. Input tasks shouldn't be canceled, otherwise the continuation is never invoked.
+	template<typename JoinChannel, typename... Tasks>
+	auto when_all(Tasks&&... tasks)
+	{
+		return details::join<details::WhenAllState, JoinChannel>(std::forward<Tasks>(tasks)...);
+	}
+
+	// Submit the tasks to their channels and pass the result of the first completed one to the continuation in the join channel.
+	// If the tasks have different result types, the result is a variant with the index of the completed task.
+	template<typename JoinChannel, typename... Tasks>
+	auto when_any(Tasks&&... tasks)
+	{
+		return details::join<details::WhenAnyState, JoinChannel>(std::forward<Tasks>(tasks)...);
+	}
+}
\ No newline at end of file
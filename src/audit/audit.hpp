@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+// Allocations made by the current thread, counted by the replaced global operator new
+struct AllocationCounters
+{
+	size_t allocations = 0;
+	size_t bytes = 0;
+};
+
+AllocationCounters& thread_allocations();
+
+// Number of paths which exceeded their budgets
+inline size_t& audit_failures()
+{
+	static size_t failures = 0;
+	return failures;
+}
+
+// Run operation twice to warm up pools and double buffered queues, then run it once more and count allocations of the current thread.
+// Every allocation of the measured run is counted, so a path which allocates only sometimes isn't hidden.
+// Fails if the average number of allocations per operation is above the budget, allocation-free paths have zero budget.
+template<typename F>
+void audit(const char* path, size_t operations, double budget, F&& operation)
+{
+	operation();
+	operation();
+
+	const AllocationCounters before = thread_allocations();
+	operation();
+	const AllocationCounters after = thread_allocations();
+
+	const AllocationCounters measured{ after.allocations - before.allocations, after.bytes - before.bytes };
+
+	const double allocations = static_cast<double>(measured.allocations) / operations;
+	const double bytes = static_cast<double>(measured.bytes) / operations;
+	const bool passed = allocations <= budget;
+
+	std::printf("%-48s %10.3f %12.1f %10.3f  %s\n", path, allocations, bytes, budget, passed ? "OK" : "FAILED");
+
+	if (!passed)
+	{
+		++audit_failures();
+	}
+}
+
+void audit_Task();
+void audit_Executors();
+void audit_Coroutine();
+
+inline int run_audits()
+{
+	std::printf("%-48s %10s %12s %10s\n", "path", "allocs/op", "bytes/op", "budget");
+
+	audit_Task();
+	audit_Executors();
+	audit_Coroutine();
+
+	return audit_failures() == 0 ? 0 : 1;
+}
\ No newline at end of file
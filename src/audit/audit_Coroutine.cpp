@@ -0,0 +1,74 @@
+#include "audit.hpp"
+#include <adl/coroutine.h>
+
+// Coroutines are audited only by the C++20 build
+#if ADL_HAS_COROUTINES
+#include <adl/dispatcher.h>
+#include <adl/executors/queue_executor.h>
+
+namespace
+{
+	enum class AuditCoroutineChannelType : int
+	{
+		Q1 = 1,
+		Q2 = 2,
+	};
+
+	using Channel_Q1 = adl::Channel<AuditCoroutineChannelType, AuditCoroutineChannelType::Q1, adl::QueueExecutor>;
+	using Channel_Q2 = adl::Channel<AuditCoroutineChannelType, AuditCoroutineChannelType::Q2, adl::QueueExecutor>;
+
+	constexpr size_t OPERATIONS = 256;
+
+	size_t g_completed = 0;
+
+	adl::co_task<size_t> generate()
+	{
+		co_return 1;
+	}
+
+	adl::co_task<> await_generate()
+	{
+		g_completed += co_await generate();
+	}
+
+	adl::co_task<> hop(size_t hops)
+	{
+		for (size_t i = 0; i < hops; i += 2)
+		{
+			co_await adl::schedule<Channel_Q1>();
+			co_await adl::schedule<Channel_Q2>();
+		}
+
+		++g_completed;
+	}
+}
+
+void audit_Coroutine()
+{
+	// Frames are taken from the pool of the thread
+	audit("co_task co_await co_task", OPERATIONS, 0.0, []
+	{
+		for (size_t i = 0; i < OPERATIONS; ++i)
+		{
+			await_generate().submit();
+		}
+	});
+
+	// Every switch is a single post to the ring of the channel, which keeps its capacity
+	audit("co_await schedule<Q1>() / schedule<Q2>()", OPERATIONS, 0.0, []
+	{
+		g_completed = 0;
+		hop(OPERATIONS).submit();
+
+		while (g_completed == 0)
+		{
+			adl::dispatch<Channel_Q1>();
+			adl::dispatch<Channel_Q2>();
+		}
+	});
+}
+#else
+void audit_Coroutine()
+{
+}
+#endif
\ No newline at end of file
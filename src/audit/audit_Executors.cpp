@@ -0,0 +1,193 @@
+#include "audit.hpp"
+#include <adl/dispatcher.h>
+#include <adl/executors/async_executor.h>
+#include <adl/executors/priority_queue_executor.h>
+#include <adl/executors/queue_executor.h>
+#include <adl/executors/strand_executor.h>
+#include <adl/executors/thread_pool_executor.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+	enum class AuditChannelType : int
+	{
+		Queue = 1,
+		LockFreeQueue = 2,
+		Strand = 3,
+		ThreadPool = 4,
+		Async = 5,
+		PriorityQueue = 6,
+		TypedQueue = 7,
+		ArenaQueue = 8,
+	};
+
+	using Channel_Queue = adl::Channel<AuditChannelType, AuditChannelType::Queue, adl::QueueExecutor>;
+	using Channel_LockFreeQueue = adl::Channel<AuditChannelType, AuditChannelType::LockFreeQueue, adl::LockFreeQueueExecutor>;
+	using Channel_Strand = adl::Channel<AuditChannelType, AuditChannelType::Strand, adl::StrandExecutor>;
+	using Channel_ThreadPool = adl::Channel<AuditChannelType, AuditChannelType::ThreadPool, adl::ThreadPoolExecutor>;
+	using Channel_Async = adl::Channel<AuditChannelType, AuditChannelType::Async, adl::AsyncExecutor>;
+	using Channel_PriorityQueue = adl::Channel<AuditChannelType, AuditChannelType::PriorityQueue, adl::PriorityQueueExecutor>;
+	using Channel_TypedQueue = adl::Channel<AuditChannelType, AuditChannelType::TypedQueue, adl::TypedQueueExecutor<void(*)()>>;
+	using Channel_ArenaQueue = adl::Channel<AuditChannelType, AuditChannelType::ArenaQueue, adl::ArenaQueueExecutor>;
+
+	constexpr size_t OPERATIONS = 256;
+
+	// Shared states of the futures are reused from the thread pool if there are not more of them than its capacity
+	constexpr size_t FUTURES_BATCH = ADL_FUTURE_STATE_POOL_CAPACITY;
+
+	std::atomic_size_t g_executed{ 0 };
+
+	void count()
+	{
+		g_executed.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	size_t generate()
+	{
+		count();
+		return 1;
+	}
+
+	// Allocation budgets per operation, allocation-free paths have zero budget.
+	// Rings of the queues are swapped by the dispatch and keep their capacity, drained arena chunks are reused
+	// and shared states released by the executor threads are returned to their pools.
+	struct Budget
+	{
+		double post;
+		double post_bulk;
+		double post_future;
+	};
+
+	template<typename ChannelType>
+	void complete(size_t tasks)
+	{
+		while (g_executed.load(std::memory_order_acquire) < tasks)
+		{
+			if constexpr (std::is_same_v<ChannelType, Channel_ThreadPool> || std::is_same_v<ChannelType, Channel_Async>)
+			{
+				std::this_thread::yield();
+			}
+			else if constexpr (!std::is_void_v<ChannelType>)
+			{
+				adl::dispatch<ChannelType>();
+			}
+		}
+
+		g_executed.store(0);
+	}
+
+	// Executor threads are blocked while the tasks of a run are posted, so the queues of the executor grow to the largest backlog
+	// and all threads are spawned before the measurement. Otherwise they depend on how fast the threads take the tasks.
+	template<typename ChannelType>
+	void saturate(size_t threads)
+	{
+		std::atomic_size_t blocked{ 0 };
+		std::atomic_bool released{ false };
+
+		for (size_t i = 0; i < threads; ++i)
+		{
+			adl::post<ChannelType>([&blocked, &released]
+			{
+				blocked.fetch_add(1);
+
+				while (!released.load())
+				{
+					std::this_thread::yield();
+				}
+			});
+		}
+
+		while (blocked.load() < threads)
+		{
+			std::this_thread::yield();
+		}
+
+		for (size_t i = 0; i < OPERATIONS; i += 4)
+		{
+			adl::post_bulk<ChannelType>(&count, &count, &count, &count);
+		}
+
+		released.store(true);
+		complete<ChannelType>(OPERATIONS);
+	}
+
+	// Allocations of the posting thread are counted, queued executors are dispatched by it as well
+	template<typename ChannelType>
+	void audit_executor(const char* executor, Budget budget)
+	{
+		const std::string name{ executor };
+
+		audit((name + " post").c_str(), OPERATIONS, budget.post, []
+		{
+			for (size_t i = 0; i < OPERATIONS; ++i)
+			{
+				adl::post<ChannelType>(&count);
+			}
+
+			complete<ChannelType>(OPERATIONS);
+		});
+
+		audit((name + " post_bulk").c_str(), OPERATIONS, budget.post_bulk, []
+		{
+			for (size_t i = 0; i < OPERATIONS; i += 4)
+			{
+				adl::post_bulk<ChannelType>(&count, &count, &count, &count);
+			}
+
+			complete<ChannelType>(OPERATIONS);
+		});
+
+		// Typed queue stores only its own task type, futures can't be posted to it
+		if constexpr (!std::is_same_v<ChannelType, Channel_TypedQueue>)
+		{
+			// Storage of the futures is reserved before the measurement
+			std::vector<adl::future<size_t>> futures;
+			futures.reserve(FUTURES_BATCH);
+
+			audit((name + " post_future").c_str(), OPERATIONS, budget.post_future, [&futures]
+			{
+				for (size_t batch = 0; batch < OPERATIONS; batch += FUTURES_BATCH)
+				{
+					for (size_t i = 0; i < FUTURES_BATCH; ++i)
+					{
+						futures.push_back(adl::post_future<ChannelType>(&generate));
+					}
+
+					complete<ChannelType>(FUTURES_BATCH);
+
+					for (auto&& future : futures)
+					{
+						future.get();
+					}
+
+					futures.clear();
+				}
+			});
+		}
+	}
+}
+
+void audit_Executors()
+{
+	audit_executor<void>("InlineExecutor", { 0.0, 0.0, 0.0 });
+	audit_executor<Channel_Queue>("QueueExecutor", { 0.0, 0.0, 0.0 });
+	// Lock-free queues push a node per task, it's the price of posting without locks
+	audit_executor<Channel_LockFreeQueue>("LockFreeQueueExecutor", { 1.0, 1.0, 1.0 });
+	audit_executor<Channel_PriorityQueue>("PriorityQueueExecutor", { 1.0, 1.0, 1.0 });
+	audit_executor<Channel_TypedQueue>("TypedQueueExecutor", { 0.0, 0.0, 0.0 });
+	audit_executor<Channel_ArenaQueue>("ArenaQueueExecutor", { 0.0, 0.0, 0.0 });
+	audit_executor<Channel_Strand>("StrandExecutor", { 0.0, 0.0, 0.0 });
+
+	// Shared state of the future released last by an executor thread goes to the pool of that thread,
+	// so the posting thread may allocate a state per future when it takes the value before the executor thread lets it go
+	saturate<Channel_ThreadPool>(adl::get_executor<Channel_ThreadPool>().workers_count());
+	audit_executor<Channel_ThreadPool>("ThreadPoolExecutor", { 0.0, 0.0, 1.0 });
+
+	// Threads of async executor are spawned on demand up to the limit, each of them allocates its state
+	saturate<Channel_Async>(ADL_ASYNC_EXECUTOR_MAX_THREADS);
+	audit_executor<Channel_Async>("AsyncExecutor", { 0.0, 0.0, 1.0 });
+}
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "audit.hpp"
+#include <adl/dispatcher.h>
+#include <adl/graph.h>
+#include <adl/task.h>
+#include <adl/executors/queue_executor.h>
+
+namespace
+{
+	enum class AuditTaskChannelType : int
+	{
+		Q1 = 1,
+		Q2 = 2,
+	};
+
+	using Channel_Q1 = adl::Channel<AuditTaskChannelType, AuditTaskChannelType::Q1, adl::QueueExecutor>;
+	using Channel_Q2 = adl::Channel<AuditTaskChannelType, AuditTaskChannelType::Q2, adl::QueueExecutor>;
+
+	constexpr size_t OPERATIONS = 256;
+
+	size_t g_value = 0;
+
+	size_t generate()
+	{
+		return 1;
+	}
+
+	size_t add(size_t value)
+	{
+		return value + 1;
+	}
+
+	void store(size_t value)
+	{
+		g_value = value;
+	}
+
+	void increment()
+	{
+		++g_value;
+	}
+
+	// Diamond graph of the node channels
+	template<typename FirstChannel, typename SecondChannel>
+	void make_diamond(adl::graph& graph)
+	{
+		const auto a = graph.node<FirstChannel>(&increment);
+		const auto b = graph.node<SecondChannel>(&increment);
+		const auto c = graph.node<SecondChannel>(&increment);
+		const auto d = graph.node<FirstChannel>(&increment);
+
+		graph.precede(a, b);
+		graph.precede(a, c);
+		graph.precede(b, d);
+		graph.precede(c, d);
+		graph.compile();
+	}
+
+	// Defers the first invocation only
+	struct DeferOnce
+	{
+		size_t operator()(adl::ExecutionContext& context, size_t value)
+		{
+			if (!deferred)
+			{
+				deferred = true;
+				context.defer();
+			}
+
+			return value;
+		}
+
+		bool deferred = false;
+	};
+}
+
+void audit_Task()
+{
+	// Tasks without channels are executed inline, nothing should be allocated
+	audit("task().then().submit() inline", OPERATIONS, 0.0, []
+	{
+		for (size_t i = 0; i < OPERATIONS; ++i)
+		{
+			adl::task(&generate).then(&add).then(&store).submit();
+		}
+	});
+
+	audit("task<void>().then<void>().submit()", OPERATIONS, 0.0, []
+	{
+		for (size_t i = 0; i < OPERATIONS; ++i)
+		{
+			adl::task<void>(&generate).then<void>(&add).then<void>(&store).submit();
+		}
+	});
+
+	// Every hop is posted to the ring of the channel, which keeps its capacity
+	audit("task<Q1>().then<Q2>().submit() + dispatch", OPERATIONS, 0.0, []
+	{
+		for (size_t i = 0; i < OPERATIONS; ++i)
+		{
+			adl::task<Channel_Q1>(&generate).then<Channel_Q2>(&add).then<Channel_Q1>(&store).submit();
+		}
+
+		adl::dispatch<Channel_Q1>();
+		adl::dispatch<Channel_Q2>();
+		adl::dispatch<Channel_Q1>();
+	});
+
+	// Deferred task is posted again to the deferred queue of the channel
+	audit("ExecutionContext::defer() re-post", OPERATIONS, 0.0, []
+	{
+		for (size_t i = 0; i < OPERATIONS; ++i)
+		{
+			adl::task<Channel_Q1>(&generate).then<Channel_Q2>(DeferOnce{}).then<Channel_Q1>(&store).submit();
+		}
+
+		adl::dispatch<Channel_Q1>();
+		adl::dispatch<Channel_Q2>();
+		adl::dispatch<Channel_Q2>();
+		adl::dispatch<Channel_Q1>();
+	});
+
+	// Compiled graph reuses its counters, nodes without channels are executed inline
+	adl::graph inlineGraph;
+	make_diamond<void, void>(inlineGraph);
+
+	audit("graph.launch() inline", OPERATIONS, 0.0, [&inlineGraph]
+	{
+		for (size_t i = 0; i < OPERATIONS; ++i)
+		{
+			inlineGraph.launch();
+		}
+	});
+
+	// Ready nodes are posted to the rings of the channels, which keep their capacity
+	adl::graph graph;
+	make_diamond<Channel_Q1, Channel_Q2>(graph);
+
+	audit("graph.launch() + dispatch", OPERATIONS, 0.0, [&graph]
+	{
+		for (size_t i = 0; i < OPERATIONS; ++i)
+		{
+			graph.launch();
+			adl::dispatch<Channel_Q1>();
+			adl::dispatch<Channel_Q2>();
+			adl::dispatch<Channel_Q1>();
+		}
+	});
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include "audit.hpp"
+#include <cstdlib>
+#include <new>
+
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+
+AllocationCounters& thread_allocations()
+{
+	thread_local AllocationCounters counters;
+	return counters;
+}
+
+namespace
+{
+	void* allocate(size_t size)
+	{
+		AllocationCounters& counters = thread_allocations();
+		++counters.allocations;
+		counters.bytes += size;
+
+		return std::malloc(size == 0 ? 1 : size);
+	}
+
+	void* allocate(size_t size, std::align_val_t alignment)
+	{
+		AllocationCounters& counters = thread_allocations();
+		++counters.allocations;
+		counters.bytes += size;
+
+		const size_t align = static_cast<size_t>(alignment);
+
+		#if defined(_MSC_VER)
+		return _aligned_malloc(size == 0 ? 1 : size, align);
+		#else
+		return std::aligned_alloc(align, (size + align - 1) / align * align);
+		#endif
+	}
+
+	void deallocate(void* memory, std::align_val_t)
+	{
+		#if defined(_MSC_VER)
+		_aligned_free(memory);
+		#else
+		std::free(memory);
+		#endif
+	}
+
+	void* allocate_or_throw(size_t size)
+	{
+		if (void* memory = allocate(size))
+		{
+			return memory;
+		}
+
+		throw std::bad_alloc{};
+	}
+
+	void* allocate_or_throw(size_t size, std::align_val_t alignment)
+	{
+		if (void* memory = allocate(size, alignment))
+		{
+			return memory;
+		}
+
+		throw std::bad_alloc{};
+	}
+}
+
+void* operator new(size_t size) { return allocate_or_throw(size); }
+void* operator new[](size_t size) { return allocate_or_throw(size); }
+void* operator new(size_t size, std::align_val_t alignment) { return allocate_or_throw(size, alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return allocate_or_throw(size, alignment); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t alignment) noexcept { deallocate(memory, alignment); }
+void operator delete[](void* memory, std::align_val_t alignment) noexcept { deallocate(memory, alignment); }
+void operator delete(void* memory, size_t, std::align_val_t alignment) noexcept { deallocate(memory, alignment); }
+void operator delete[](void* memory, size_t, std::align_val_t alignment) noexcept { deallocate(memory, alignment); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+
+int main()
+{
+	return run_audits();
+}
\ No newline at end of file
@@ -0,0 +1,298 @@
+#pragma once
+#include <adl/atomic_wait.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+using bench_clock = std::chrono::steady_clock;
+
+struct BenchOptions
+{
+	enum class Format
+	{
+		Json,
+		Csv
+	};
+
+	Format format = Format::Json;
+	std::string output;
+	std::string filter;
+	size_t tasks = 1 << 16;
+	size_t samples = 10000;
+	size_t repetitions = 3;
+	size_t maxProducers = std::max(std::thread::hardware_concurrency(), 1u);
+
+	// Benchmark is skipped if its name doesn't contain the filter
+	bool enabled(const std::string& name) const
+	{
+		return filter.empty() || name.find(filter) != std::string::npos;
+	}
+
+	// 1, 2, 4 ... up to the max producers count
+	std::vector<size_t> producers() const
+	{
+		std::vector<size_t> counts;
+
+		for (size_t count = 1; count < maxProducers; count *= 2)
+		{
+			counts.push_back(count);
+		}
+
+		counts.push_back(maxProducers);
+		return counts;
+	}
+};
+
+// Single result of the benchmark, fields are written in the order they are added
+class BenchRow
+{
+public:
+
+	BenchRow& add(const char* name, const std::string& value)
+	{
+		m_fields.push_back({ name, value, false });
+		return *this;
+	}
+
+	BenchRow& add(const char* name, const char* value)
+	{
+		return add(name, std::string{ value });
+	}
+
+	BenchRow& add(const char* name, size_t value)
+	{
+		m_fields.push_back({ name, std::to_string(value), true });
+		return *this;
+	}
+
+	BenchRow& add(const char* name, double value)
+	{
+		char buffer[64];
+		std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+		m_fields.push_back({ name, buffer, true });
+		return *this;
+	}
+
+private:
+
+	friend class BenchReport;
+
+	struct Field
+	{
+		std::string name;
+		std::string value;
+		bool numeric;
+	};
+
+	std::vector<Field> m_fields;
+};
+
+// Collects benchmark results and writes them as JSON array or CSV
+class BenchReport
+{
+public:
+
+	explicit BenchReport(const BenchOptions& options)
+		: m_options{ options }
+	{}
+
+	void add(BenchRow row)
+	{
+		m_rows.push_back(std::move(row));
+	}
+
+	bool write() const
+	{
+		FILE* file = m_options.output.empty() ? stdout : std::fopen(m_options.output.c_str(), "w");
+
+		if (file == nullptr)
+		{
+			std::fprintf(stderr, "Can't open %s\n", m_options.output.c_str());
+			return false;
+		}
+
+		if (m_options.format == BenchOptions::Format::Json)
+		{
+			write_json(file);
+		}
+		else
+		{
+			write_csv(file);
+		}
+
+		if (file != stdout)
+		{
+			std::fclose(file);
+		}
+
+		return true;
+	}
+
+private:
+
+	void write_json(FILE* file) const
+	{
+		std::fprintf(file, "[\n");
+
+		for (size_t i = 0; i < m_rows.size(); ++i)
+		{
+			std::fprintf(file, "  {");
+
+			for (size_t j = 0; j < m_rows[i].m_fields.size(); ++j)
+			{
+				const BenchRow::Field& field = m_rows[i].m_fields[j];
+				const char* quote = field.numeric ? "" : "\"";
+
+				std::fprintf(file, "%s\"%s\": %s%s%s", j == 0 ? "" : ", ", field.name.c_str(), quote, field.value.c_str(), quote);
+			}
+
+			std::fprintf(file, "}%s\n", i + 1 < m_rows.size() ? "," : "");
+		}
+
+		std::fprintf(file, "]\n");
+	}
+
+	// Header is written again when the set of columns is changed
+	void write_csv(FILE* file) const
+	{
+		std::string header;
+
+		for (const BenchRow& row : m_rows)
+		{
+			std::string columns;
+			std::string values;
+
+			for (const BenchRow::Field& field : row.m_fields)
+			{
+				columns += (columns.empty() ? "" : ",") + field.name;
+				values += (values.empty() ? "" : ",") + field.value;
+			}
+
+			if (columns != header)
+			{
+				header = columns;
+				std::fprintf(file, "%s\n", header.c_str());
+			}
+
+			std::fprintf(file, "%s\n", values.c_str());
+		}
+	}
+
+	const BenchOptions& m_options;
+	std::vector<BenchRow> m_rows;
+};
+
+// Prevent compiler from optimizing away the value
+template<typename T>
+inline void do_not_optimize(const T& value)
+{
+	#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "r,m"(value) : "memory");
+	#else
+	const volatile char sink = *reinterpret_cast<const volatile char*>(&value);
+	(void)sink;
+	_ReadWriteBarrier();
+	#endif
+}
+
+// CPU bound work of the benchmark tasks
+inline uint64_t spin_work(uint64_t seed, size_t iterations)
+{
+	for (size_t i = 0; i < iterations; ++i)
+	{
+		seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+	}
+
+	return seed;
+}
+
+inline double seconds_since(bench_clock::time_point begin)
+{
+	return std::chrono::duration<double>(bench_clock::now() - begin).count();
+}
+
+// Start producers at the same time and run consumer on the current thread,
+// returns seconds from the start until the consumer and all producers are finished.
+template<typename Produce, typename Consume>
+double run_producers(size_t producers, Produce&& produce, Consume&& consume)
+{
+	std::atomic_bool started{ false };
+	std::atomic_size_t ready{ 0 };
+	std::vector<std::thread> threads;
+	threads.reserve(producers);
+
+	for (size_t i = 0; i < producers; ++i)
+	{
+		threads.emplace_back([&, i]
+		{
+			ready.fetch_add(1);
+
+			while (!started.load(std::memory_order_acquire))
+			{
+				adl::details::cpu_relax();
+			}
+
+			produce(i);
+		});
+	}
+
+	while (ready.load() < producers)
+	{
+		std::this_thread::yield();
+	}
+
+	const bench_clock::time_point begin = bench_clock::now();
+	started.store(true, std::memory_order_release);
+
+	consume();
+
+	for (auto&& thread : threads)
+	{
+		thread.join();
+	}
+
+	return seconds_since(begin);
+}
+
+// Median of the measurements
+inline double median(std::vector<double> values)
+{
+	std::sort(values.begin(), values.end());
+	return values.empty() ? 0.0 : values[values.size() / 2];
+}
+
+// Nearest-rank percentile of the sorted values
+inline double percentile(const std::vector<double>& sortedValues, double fraction)
+{
+	if (sortedValues.empty())
+	{
+		return 0.0;
+	}
+
+	const size_t rank = static_cast<size_t>(fraction * sortedValues.size() + 0.5);
+	return sortedValues[std::min(std::max<size_t>(rank, 1), sortedValues.size()) - 1];
+}
+
+void bench_Executors(const BenchOptions& options, BenchReport& report);
+void bench_TaskChain(const BenchOptions& options, BenchReport& report);
+void bench_Timers(const BenchOptions& options, BenchReport& report);
+
+inline void run_benchmarks(const BenchOptions& options, BenchReport& report)
+{
+	bench_Executors(options, report);
+	bench_TaskChain(options, report);
+	bench_Timers(options, report);
+}
\ No newline at end of file
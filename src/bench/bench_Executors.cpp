@@ -0,0 +1,298 @@
+#include "bench.hpp"
+#include <adl/dispatcher.h>
+#include <adl/executors/async_executor.h>
+#include <adl/executors/priority_queue_executor.h>
+#include <adl/executors/queue_executor.h>
+#include <adl/executors/strand_executor.h>
+#include <adl/executors/thread_pool_executor.h>
+#include <array>
+#include <type_traits>
+
+namespace
+{
+	enum class BenchChannelType : int
+	{
+		Queue = 1,
+		LockFreeQueue = 2,
+		Strand = 3,
+		ThreadPool = 4,
+		Async = 5,
+		PriorityQueue = 6,
+		TypedQueue = 7,
+		ArenaQueue = 8,
+	};
+
+	using Channel_Queue = adl::Channel<BenchChannelType, BenchChannelType::Queue, adl::QueueExecutor>;
+	using Channel_LockFreeQueue = adl::Channel<BenchChannelType, BenchChannelType::LockFreeQueue, adl::LockFreeQueueExecutor>;
+	using Channel_Strand = adl::Channel<BenchChannelType, BenchChannelType::Strand, adl::StrandExecutor>;
+	using Channel_ThreadPool = adl::Channel<BenchChannelType, BenchChannelType::ThreadPool, adl::ThreadPoolExecutor>;
+	using Channel_Async = adl::Channel<BenchChannelType, BenchChannelType::Async, adl::AsyncExecutor>;
+	using Channel_PriorityQueue = adl::Channel<BenchChannelType, BenchChannelType::PriorityQueue, adl::PriorityQueueExecutor>;
+	using Channel_ArenaQueue = adl::Channel<BenchChannelType, BenchChannelType::ArenaQueue, adl::ArenaQueueExecutor>;
+
+	// Typed executor stores a single task type, so every task type is posted to its own channel
+	struct TypedQueue {};
+
+	template<typename ChannelType, typename TaskType>
+	struct bench_channel
+	{
+		using type = ChannelType;
+	};
+
+	template<typename TaskType>
+	struct bench_channel<TypedQueue, TaskType>
+	{
+		using type = adl::Channel<BenchChannelType, BenchChannelType::TypedQueue, adl::TypedQueueExecutor<TaskType>>;
+	};
+
+	// Iterations of the CPU bound task
+	constexpr size_t WORK_ITERATIONS = 256;
+
+	// Number of tasks in a single post_bulk call
+	constexpr size_t BULK_SIZE = 4;
+
+	std::atomic_size_t g_executed{ 0 };
+
+	// Tasks of the queued executors are executed by the thread which calls dispatch
+	template<typename ChannelType>
+	struct is_dispatched : std::true_type {};
+
+	template<>
+	struct is_dispatched<void> : std::false_type {};
+
+	template<>
+	struct is_dispatched<Channel_ThreadPool> : std::false_type {};
+
+	template<>
+	struct is_dispatched<Channel_Async> : std::false_type {};
+
+	template<size_t CaptureSize, bool CpuBound>
+	struct BenchTask
+	{
+		void operator()()
+		{
+			if constexpr (CpuBound)
+			{
+				do_not_optimize(spin_work(capture[0], WORK_ITERATIONS));
+			}
+
+			g_executed.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		std::array<unsigned char, CaptureSize> capture{};
+	};
+
+	// Wait until all posted tasks are executed, queued executors are dispatched by the current thread
+	template<typename ChannelType>
+	void drain(size_t tasks)
+	{
+		while (g_executed.load(std::memory_order_acquire) < tasks)
+		{
+			if constexpr (is_dispatched<ChannelType>::value)
+			{
+				adl::dispatch<ChannelType>();
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	template<typename ChannelType, typename TaskType>
+	double bench_post(size_t producers, size_t tasksPerProducer)
+	{
+		const double seconds = run_producers(producers, [&](size_t)
+		{
+			for (size_t i = 0; i < tasksPerProducer; ++i)
+			{
+				adl::post<ChannelType>(TaskType{});
+			}
+		},
+			[] {});
+
+		drain<ChannelType>(producers * tasksPerProducer);
+		return seconds;
+	}
+
+	template<typename ChannelType, typename TaskType>
+	double bench_post_bulk(size_t producers, size_t tasksPerProducer)
+	{
+		const double seconds = run_producers(producers, [&](size_t)
+		{
+			for (size_t i = 0; i < tasksPerProducer; i += BULK_SIZE)
+			{
+				adl::post_bulk<ChannelType>(TaskType{}, TaskType{}, TaskType{}, TaskType{});
+			}
+		},
+			[] {});
+
+		drain<ChannelType>(producers * tasksPerProducer);
+		return seconds;
+	}
+
+	template<typename ChannelType, typename TaskType>
+	double bench_post_future(size_t producers, size_t tasksPerProducer)
+	{
+		using future_t = decltype(adl::post_future<ChannelType>(TaskType{}));
+
+		std::vector<std::vector<future_t>> futures(producers);
+
+		for (auto&& producerFutures : futures)
+		{
+			producerFutures.reserve(tasksPerProducer);
+		}
+
+		const double seconds = run_producers(producers, [&](size_t producer)
+		{
+			for (size_t i = 0; i < tasksPerProducer; ++i)
+			{
+				futures[producer].push_back(adl::post_future<ChannelType>(TaskType{}));
+			}
+		},
+			[] {});
+
+		drain<ChannelType>(producers * tasksPerProducer);
+
+		for (auto&& producerFutures : futures)
+		{
+			for (auto&& future : producerFutures)
+			{
+				future.get();
+			}
+		}
+
+		return seconds;
+	}
+
+	// Time of dispatching tasks which are already in the queue
+	template<typename ChannelType, typename TaskType>
+	double bench_dispatch(size_t producers, size_t tasksPerProducer)
+	{
+		run_producers(producers, [&](size_t)
+		{
+			for (size_t i = 0; i < tasksPerProducer; ++i)
+			{
+				adl::post<ChannelType>(TaskType{});
+			}
+		},
+			[] {});
+
+		const bench_clock::time_point begin = bench_clock::now();
+		drain<ChannelType>(producers * tasksPerProducer);
+
+		return seconds_since(begin);
+	}
+
+	// Time from the start of posting until all tasks are executed, consumer runs concurrently with producers
+	template<typename ChannelType, typename TaskType>
+	double bench_roundtrip(size_t producers, size_t tasksPerProducer)
+	{
+		return run_producers(producers, [&](size_t)
+		{
+			for (size_t i = 0; i < tasksPerProducer; ++i)
+			{
+				adl::post<ChannelType>(TaskType{});
+			}
+		},
+			[&] { drain<ChannelType>(producers * tasksPerProducer); });
+	}
+
+	template<typename Bench>
+	void measure(const BenchOptions& options, BenchReport& report, const char* executor, const char* operation,
+		size_t captureSize, const char* work, size_t producers, size_t tasksPerProducer, Bench&& bench)
+	{
+		std::vector<double> measurements;
+
+		for (size_t i = 0; i < options.repetitions; ++i)
+		{
+			g_executed.store(0);
+			measurements.push_back(bench(producers, tasksPerProducer));
+		}
+
+		const size_t tasks = producers * tasksPerProducer;
+		const double seconds = median(std::move(measurements));
+
+		report.add(BenchRow{}
+			.add("benchmark", "executors")
+			.add("executor", executor)
+			.add("operation", operation)
+			.add("producers", producers)
+			.add("capture_size", captureSize)
+			.add("work", work)
+			.add("tasks", tasks)
+			.add("seconds", seconds)
+			.add("tasks_per_second", tasks / seconds)
+			.add("ns_per_task", seconds * 1e9 / tasks));
+	}
+
+	template<typename ChannelType, size_t CaptureSize, bool CpuBound>
+	void bench_executor_task(const BenchOptions& options, BenchReport& report, const char* executor)
+	{
+		using task_t = BenchTask<CaptureSize, CpuBound>;
+		using channel_t = typename bench_channel<ChannelType, task_t>::type;
+
+		const char* work = CpuBound ? "cpu" : "empty";
+		const std::string prefix = std::string{ "executors/" } + executor + "/";
+
+		for (size_t producers : options.producers())
+		{
+			// Every producer posts the same number of tasks, rounded to the bulk size
+			const size_t tasksPerProducer = std::max<size_t>(options.tasks / producers / BULK_SIZE, 1) * BULK_SIZE;
+
+			if (options.enabled(prefix + "post"))
+			{
+				measure(options, report, executor, "post", sizeof(task_t), work, producers, tasksPerProducer, &bench_post<channel_t, task_t>);
+			}
+
+			if (options.enabled(prefix + "post_bulk"))
+			{
+				measure(options, report, executor, "post_bulk", sizeof(task_t), work, producers, tasksPerProducer, &bench_post_bulk<channel_t, task_t>);
+			}
+
+			// Futures can't be posted to the typed queue
+			if constexpr (!std::is_same_v<ChannelType, TypedQueue>)
+			{
+				if (options.enabled(prefix + "post_future"))
+				{
+					measure(options, report, executor, "post_future", sizeof(task_t), work, producers, tasksPerProducer, &bench_post_future<channel_t, task_t>);
+				}
+			}
+
+			if (is_dispatched<channel_t>::value && options.enabled(prefix + "dispatch"))
+			{
+				measure(options, report, executor, "dispatch", sizeof(task_t), work, producers, tasksPerProducer, &bench_dispatch<channel_t, task_t>);
+			}
+
+			if (options.enabled(prefix + "roundtrip"))
+			{
+				measure(options, report, executor, "roundtrip", sizeof(task_t), work, producers, tasksPerProducer, &bench_roundtrip<channel_t, task_t>);
+			}
+		}
+	}
+
+	// Captures fit into the inline buffer of the execution agent, fill it completely and exceed it
+	template<typename ChannelType>
+	void bench_executor(const BenchOptions& options, BenchReport& report, const char* executor)
+	{
+		constexpr size_t INLINE_SIZE = adl::ExecutionAgent<>::inline_size;
+
+		bench_executor_task<ChannelType, sizeof(void*), false>(options, report, executor);
+		bench_executor_task<ChannelType, INLINE_SIZE, false>(options, report, executor);
+		bench_executor_task<ChannelType, INLINE_SIZE * 2, false>(options, report, executor);
+		bench_executor_task<ChannelType, sizeof(void*), true>(options, report, executor);
+	}
+}
+
+void bench_Executors(const BenchOptions& options, BenchReport& report)
+{
+	bench_executor<void>(options, report, "InlineExecutor");
+	bench_executor<Channel_Queue>(options, report, "QueueExecutor");
+	bench_executor<Channel_LockFreeQueue>(options, report, "LockFreeQueueExecutor");
+	bench_executor<Channel_PriorityQueue>(options, report, "PriorityQueueExecutor");
+	bench_executor<TypedQueue>(options, report, "TypedQueueExecutor");
+	bench_executor<Channel_ArenaQueue>(options, report, "ArenaQueueExecutor");
+	bench_executor<Channel_Strand>(options, report, "StrandExecutor");
+	bench_executor<Channel_ThreadPool>(options, report, "ThreadPoolExecutor");
+	bench_executor<Channel_Async>(options, report, "AsyncExecutor");
+}
\ No newline at end of file
@@ -0,0 +1,332 @@
+#include "bench.hpp"
+#include <adl/dispatcher.h>
+#include <adl/task.h>
+#include <adl/executors/queue_executor.h>
+#include <array>
+#include <type_traits>
+
+namespace
+{
+	enum class ChainChannelType : int
+	{
+		A = 1,
+		B = 2,
+	};
+
+	using Channel_A = adl::Channel<ChainChannelType, ChainChannelType::A, adl::QueueExecutor>;
+	using Channel_B = adl::Channel<ChainChannelType, ChainChannelType::B, adl::QueueExecutor>;
+
+	constexpr size_t MAX_HOPS = 64;
+
+	enum class ChainContext
+	{
+		// Plain execution agents
+		None,
+		// Every hop is deferred once before it is executed
+		Defer,
+		// Every hop takes execution context and the last one cancels the rest of the chain
+		Cancel
+	};
+
+	enum class DispatchMode
+	{
+		// Every channel is dispatched by its own thread
+		Dedicated,
+		// Single thread dispatches all channels in turn
+		Polled,
+		// Every channel is run by its own thread, which is parked while the channel is empty
+		Parked
+	};
+
+	enum class ChainChannels
+	{
+		// All hops are in the same channel, they are invoked inline up to ADL_MAX_INLINE_HOPS deep
+		Same,
+		// All hops are in the same channel, but every hop is posted with then_post
+		Requeue,
+		// Hops alternate between two channels
+		Cross
+	};
+
+	const char* to_string(ChainChannels channels)
+	{
+		return channels == ChainChannels::Same ? "same" : channels == ChainChannels::Requeue ? "requeue" : "cross";
+	}
+
+	const char* to_string(ChainContext context)
+	{
+		return context == ChainContext::None ? "none" : context == ChainContext::Defer ? "defer" : "cancel";
+	}
+
+	const char* to_string(DispatchMode mode)
+	{
+		return mode == DispatchMode::Dedicated ? "dedicated" : mode == DispatchMode::Polled ? "polled" : "parked";
+	}
+
+	// Timestamps of a single chain execution, stamp 0 is taken by the first agent and stamp N by the N-th hop
+	struct Sample
+	{
+		std::array<bench_clock::time_point, MAX_HOPS + 1> stamps;
+		std::atomic_bool done{ false };
+	};
+
+	struct Start
+	{
+		size_t operator()() const
+		{
+			sample->stamps[0] = bench_clock::now();
+			return 0;
+		}
+
+		Sample* sample;
+	};
+
+	inline size_t stamp(Sample* sample, size_t index, size_t last, size_t value)
+	{
+		sample->stamps[index] = bench_clock::now();
+
+		if (index == last)
+		{
+			sample->done.store(true, std::memory_order_release);
+		}
+
+		return value + 1;
+	}
+
+	struct Hop
+	{
+		size_t operator()(size_t value) const
+		{
+			return stamp(sample, index, last, value);
+		}
+
+		Sample* sample;
+		size_t index;
+		size_t last;
+	};
+
+	template<ChainContext Context>
+	struct ContextHop
+	{
+		size_t operator()(adl::ExecutionContext& context, size_t value)
+		{
+			if constexpr (Context == ChainContext::Defer)
+			{
+				if (!deferred)
+				{
+					deferred = true;
+					context.defer();
+					return value;
+				}
+			}
+			else if (index == last)
+			{
+				context.cancel();
+			}
+
+			return stamp(sample, index, last, value);
+		}
+
+		Sample* sample;
+		size_t index;
+		size_t last;
+		bool deferred = false;
+	};
+
+	// Last agent is executed inline after the last hop, it is not invoked if the chain is canceled
+	struct Finish
+	{
+		void operator()(size_t) const
+		{}
+	};
+
+	template<ChainContext Context>
+	auto make_hop(Sample& sample, size_t index, size_t last)
+	{
+		if constexpr (Context == ChainContext::None)
+		{
+			return Hop{ &sample, index, last };
+		}
+		else
+		{
+			return ContextHop<Context>{ &sample, index, last };
+		}
+	}
+
+	// Append hops from Index to Hops, with cross channel hops the chain alternates between channels
+	template<size_t Index, size_t Hops, ChainChannels Channels, ChainContext Context, typename TaskType>
+	auto extend_chain(TaskType&& task, Sample& sample)
+	{
+		if constexpr (Index > Hops)
+		{
+			return task.then(Finish{});
+		}
+		else if constexpr (Channels == ChainChannels::Requeue)
+		{
+			return extend_chain<Index + 1, Hops, Channels, Context>(task.template then_post<Channel_A>(make_hop<Context>(sample, Index, Hops)), sample);
+		}
+		else
+		{
+			using channel_t = std::conditional_t<Channels == ChainChannels::Cross && Index % 2 == 1, Channel_B, Channel_A>;
+			return extend_chain<Index + 1, Hops, Channels, Context>(task.template then<channel_t>(make_hop<Context>(sample, Index, Hops)), sample);
+		}
+	}
+
+	// Threads which dispatch chain channels until stopped
+	class Dispatchers
+	{
+	public:
+
+		Dispatchers(DispatchMode mode, bool cross)
+		{
+			if (mode == DispatchMode::Polled)
+			{
+				m_threads.emplace_back([this, cross]
+				{
+					while (!m_stopped.load(std::memory_order_relaxed))
+					{
+						adl::dispatch<Channel_A>();
+
+						if (cross)
+						{
+							adl::dispatch<Channel_B>();
+						}
+
+						std::this_thread::yield();
+					}
+				});
+			}
+			else if (mode == DispatchMode::Parked)
+			{
+				m_threads.emplace_back([token = m_stop.get_token()] { adl::run_until<Channel_A>(token); });
+
+				if (cross)
+				{
+					m_threads.emplace_back([token = m_stop.get_token()] { adl::run_until<Channel_B>(token); });
+				}
+			}
+			else
+			{
+				m_threads.emplace_back([this] { spin<Channel_A>(); });
+
+				if (cross)
+				{
+					m_threads.emplace_back([this] { spin<Channel_B>(); });
+				}
+			}
+		}
+
+		~Dispatchers()
+		{
+			m_stopped.store(true);
+			m_stop.request_stop();
+
+			for (auto&& thread : m_threads)
+			{
+				thread.join();
+			}
+		}
+
+	private:
+
+		template<typename ChannelType>
+		void spin()
+		{
+			while (!m_stopped.load(std::memory_order_relaxed))
+			{
+				adl::dispatch<ChannelType>();
+			}
+		}
+
+		std::atomic_bool m_stopped{ false };
+		adl::stop_source m_stop;
+		std::vector<std::thread> m_threads;
+	};
+
+	template<size_t Hops, ChainChannels Channels, ChainContext Context>
+	void bench_chain(const BenchOptions& options, BenchReport& report, DispatchMode mode)
+	{
+		constexpr bool Cross = Channels == ChainChannels::Cross;
+		const std::string name = std::string{ "task_chain/" } + to_string(Channels) + "/" + to_string(mode) + "/" + to_string(Context);
+
+		if (!options.enabled(name))
+		{
+			return;
+		}
+
+		std::vector<double> endToEnd;
+		std::vector<double> hops;
+		endToEnd.reserve(options.samples);
+		hops.reserve(options.samples * Hops);
+
+		Sample sample;
+		Dispatchers dispatchers{ mode, Cross };
+
+		for (size_t i = 0; i < options.samples; ++i)
+		{
+			sample.done.store(false);
+
+			// Chain is built and submitted inside of the measured interval
+			const bench_clock::time_point posted = bench_clock::now();
+			extend_chain<1, Hops, Channels, Context>(adl::task<Channel_A>(Start{ &sample }), sample).submit();
+
+			// Yield after spinning, so dispatchers are not starved when there are not enough cores
+			while (!adl::details::spin_until([&] { return sample.done.load(std::memory_order_acquire); }, 1024))
+			{
+				std::this_thread::yield();
+			}
+
+			endToEnd.push_back(std::chrono::duration<double, std::nano>(sample.stamps[Hops] - posted).count());
+
+			for (size_t hop = 1; hop <= Hops; ++hop)
+			{
+				hops.push_back(std::chrono::duration<double, std::nano>(sample.stamps[hop] - sample.stamps[hop - 1]).count());
+			}
+		}
+
+		std::sort(endToEnd.begin(), endToEnd.end());
+		std::sort(hops.begin(), hops.end());
+
+		report.add(BenchRow{}
+			.add("benchmark", "task_chain")
+			.add("hops", Hops)
+			.add("channels", to_string(Channels))
+			.add("dispatch", to_string(mode))
+			.add("context", to_string(Context))
+			.add("samples", options.samples)
+			.add("e2e_p50_ns", percentile(endToEnd, 0.5))
+			.add("e2e_p99_ns", percentile(endToEnd, 0.99))
+			.add("e2e_p999_ns", percentile(endToEnd, 0.999))
+			.add("hop_p50_ns", percentile(hops, 0.5))
+			.add("hop_p99_ns", percentile(hops, 0.99))
+			.add("hop_p999_ns", percentile(hops, 0.999)));
+	}
+
+	template<size_t Hops>
+	void bench_chain_hops(const BenchOptions& options, BenchReport& report)
+	{
+		static_assert(Hops <= MAX_HOPS);
+
+		for (DispatchMode mode : { DispatchMode::Dedicated, DispatchMode::Polled, DispatchMode::Parked })
+		{
+			bench_chain<Hops, ChainChannels::Same, ChainContext::None>(options, report, mode);
+			bench_chain<Hops, ChainChannels::Requeue, ChainContext::None>(options, report, mode);
+			bench_chain<Hops, ChainChannels::Cross, ChainContext::None>(options, report, mode);
+			bench_chain<Hops, ChainChannels::Same, ChainContext::Defer>(options, report, mode);
+			bench_chain<Hops, ChainChannels::Cross, ChainContext::Defer>(options, report, mode);
+			bench_chain<Hops, ChainChannels::Same, ChainContext::Cancel>(options, report, mode);
+			bench_chain<Hops, ChainChannels::Cross, ChainContext::Cancel>(options, report, mode);
+		}
+	}
+}
+
+void bench_TaskChain(const BenchOptions& options, BenchReport& report)
+{
+	bench_chain_hops<1>(options, report);
+	bench_chain_hops<2>(options, report);
+	bench_chain_hops<4>(options, report);
+	bench_chain_hops<8>(options, report);
+	bench_chain_hops<16>(options, report);
+	bench_chain_hops<32>(options, report);
+	bench_chain_hops<64>(options, report);
+}
\ No newline at end of file
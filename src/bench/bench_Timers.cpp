@@ -0,0 +1,112 @@
+#include "bench.hpp"
+#include <adl/timers.h>
+#include <adl/executors/queue_executor.h>
+
+namespace
+{
+	enum class TimerChannelType : int
+	{
+		T = 1,
+	};
+
+	using Channel_T = adl::Channel<TimerChannelType, TimerChannelType::T, adl::LockFreeQueueExecutor>;
+
+	// Number of pending timers while the operations are measured
+	constexpr size_t PENDING_TIMERS = 100000;
+
+	void report_timers(BenchReport& report, const char* operation, size_t operations, double seconds)
+	{
+		report.add(BenchRow{}
+			.add("benchmark", "timers")
+			.add("operation", operation)
+			.add("pending", PENDING_TIMERS)
+			.add("operations", operations)
+			.add("seconds", seconds)
+			.add("ns_per_operation", seconds * 1e9 / operations));
+	}
+
+	// Insert and cancel timers of the process-wide timer executor, deadlines are spread over a minute
+	void bench_timer_executor(const BenchOptions& options, BenchReport& report)
+	{
+		std::vector<adl::TimerHandle> timers;
+		timers.reserve(PENDING_TIMERS);
+
+		std::vector<double> inserts;
+		std::vector<double> cancels;
+
+		for (size_t repetition = 0; repetition < options.repetitions; ++repetition)
+		{
+			const bench_clock::time_point begin = bench_clock::now();
+
+			for (size_t i = 0; i < PENDING_TIMERS; ++i)
+			{
+				timers.push_back(adl::post_after<Channel_T>(std::chrono::milliseconds{ 1000 + i * 60000 / PENDING_TIMERS }, [] {}));
+			}
+
+			inserts.push_back(seconds_since(begin));
+
+			const bench_clock::time_point cancelBegin = bench_clock::now();
+
+			for (auto&& timer : timers)
+			{
+				timer.cancel();
+			}
+
+			cancels.push_back(seconds_since(cancelBegin));
+			timers.clear();
+		}
+
+		report_timers(report, "insert", PENDING_TIMERS, median(std::move(inserts)));
+		report_timers(report, "cancel", PENDING_TIMERS, median(std::move(cancels)));
+	}
+
+	// Advance the wheel tick by tick while the timers are pending, every tick expires the same number of timers
+	void bench_timing_wheel(const BenchOptions& options, BenchReport& report)
+	{
+		constexpr size_t TICKS = 1 << 16;
+
+		std::vector<double> advances;
+		std::vector<adl::details::TimingWheel<size_t>::Node*> expired;
+
+		for (size_t repetition = 0; repetition < options.repetitions; ++repetition)
+		{
+			adl::details::TimingWheel<size_t> wheel;
+
+			for (size_t i = 0; i < PENDING_TIMERS; ++i)
+			{
+				wheel.insert(1 + i % TICKS, i);
+			}
+
+			const bench_clock::time_point begin = bench_clock::now();
+
+			for (uint64_t tick = 1; tick <= TICKS; ++tick)
+			{
+				wheel.advance(tick, expired);
+
+				for (auto* node : expired)
+				{
+					wheel.release(node);
+				}
+
+				expired.clear();
+			}
+
+			advances.push_back(seconds_since(begin));
+		}
+
+		report_timers(report, "advance_tick", TICKS, median(std::move(advances)));
+	}
+}
+
+void bench_Timers(const BenchOptions& options, BenchReport& report)
+{
+	if (options.enabled("timers/executor"))
+	{
+		bench_timer_executor(options, report);
+	}
+
+	if (options.enabled("timers/wheel"))
+	{
+		bench_timing_wheel(options, report);
+	}
+}
\ No newline at end of file
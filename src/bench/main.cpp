@@ -0,0 +1,95 @@
+#include "bench.hpp"
+
+namespace
+{
+	void print_usage(const char* name)
+	{
+		std::fprintf(stderr,
+			"Usage: %s [options]\n"
+			"  --format json|csv      output format, json by default\n"
+			"  --output <file>        write results to the file instead of stdout\n"
+			"  --filter <substring>   run only benchmarks which names contain the substring\n"
+			"  --tasks <count>        number of tasks per measurement\n"
+			"  --repetitions <count>  number of measurements, median is reported\n"
+			"  --samples <count>      number of latency samples\n"
+			"  --producers <count>    max number of producer threads\n",
+			name);
+	}
+
+	bool parse_options(int argc, char** argv, BenchOptions& options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string option = argv[i];
+
+			if (i + 1 >= argc)
+			{
+				return false;
+			}
+
+			const char* value = argv[++i];
+
+			if (option == "--format")
+			{
+				if (std::strcmp(value, "json") == 0)
+				{
+					options.format = BenchOptions::Format::Json;
+				}
+				else if (std::strcmp(value, "csv") == 0)
+				{
+					options.format = BenchOptions::Format::Csv;
+				}
+				else
+				{
+					return false;
+				}
+			}
+			else if (option == "--output")
+			{
+				options.output = value;
+			}
+			else if (option == "--filter")
+			{
+				options.filter = value;
+			}
+			else if (option == "--tasks")
+			{
+				options.tasks = std::max<size_t>(std::strtoull(value, nullptr, 10), 1);
+			}
+			else if (option == "--repetitions")
+			{
+				options.repetitions = std::max<size_t>(std::strtoull(value, nullptr, 10), 1);
+			}
+			else if (option == "--samples")
+			{
+				options.samples = std::max<size_t>(std::strtoull(value, nullptr, 10), 1);
+			}
+			else if (option == "--producers")
+			{
+				options.maxProducers = std::max<size_t>(std::strtoull(value, nullptr, 10), 1);
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	BenchOptions options;
+
+	if (!parse_options(argc, argv, options))
+	{
+		print_usage(argv[0]);
+		return 1;
+	}
+
+	BenchReport report{ options };
+	run_benchmarks(options, report);
+
+	return report.write() ? 0 : 1;
+}
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include <assert.h>
+#include <cstddef>
 
 template<size_t ID>
 struct ValueHolder
@@ -57,23 +58,55 @@ constexpr size_t generate()
 
 void test_Placeholder();
 void test_ExecutionContext();
+void test_ExecutionAgent();
+void test_ExecutorStats();
+void test_ExecutorRegistry();
+void test_Future();
 void test_QueueEecutor();
+void test_LockFreeQueueExecutor();
+void test_PriorityQueueExecutor();
+void test_TypedQueueExecutor();
+void test_ArenaQueueExecutor();
 void test_AsyncExecutor();
 void test_InlineExecutor();
+void test_ChannelThread();
+void test_ChannelSet();
+void test_ChannelConcurrency();
+void test_Timers();
 void test_StrandEecutor();
+void test_ThreadPoolExecutor();
 void test_Task();
 void test_Task_Channel();
 void test_Task_ExecutionContext();
+void test_WhenAll();
+void test_Graph();
+void test_Coroutine();
 
 inline void run_tests()
 {
 	test_Placeholder();
 	test_ExecutionContext();
+	test_ExecutionAgent();
+	test_ExecutorStats();
+	test_ExecutorRegistry();
+	test_Future();
 	test_QueueEecutor();
+	test_LockFreeQueueExecutor();
+	test_PriorityQueueExecutor();
+	test_TypedQueueExecutor();
+	test_ArenaQueueExecutor();
 	test_StrandEecutor();
+	test_ThreadPoolExecutor();
 	test_AsyncExecutor();
 	test_InlineExecutor();
+	test_ChannelThread();
+	test_ChannelSet();
+	test_ChannelConcurrency();
+	test_Timers();
 	test_Task();
 	test_Task_Channel();	
 	test_Task_ExecutionContext();
+	test_WhenAll();
+	test_Graph();
+	test_Coroutine();
 }
\ No newline at end of file
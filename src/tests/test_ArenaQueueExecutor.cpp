@@ -0,0 +1,238 @@
+#include "test.hpp"
+#include <adl/channel_thread.h>
+#include <adl/executors/queue_executor.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+	enum class ArenaQueueChannelType : int
+	{
+		Q1 = 1,
+		Q2 = 2,
+		S1 = 3,
+		T1 = 4,
+	};
+
+	using Channel_Q1 = adl::Channel<ArenaQueueChannelType, ArenaQueueChannelType::Q1, adl::ArenaQueueExecutor>;
+	using Channel_Q2 = adl::Channel<ArenaQueueChannelType, ArenaQueueChannelType::Q2, adl::ArenaQueueExecutor>;
+	using Channel_S1 = adl::Channel<ArenaQueueChannelType, ArenaQueueChannelType::S1, adl::ArenaQueueExecutor, adl::Concurrency::SingleThread>;
+
+	// Dispatched in a separate thread
+	using Channel_T1 = adl::Channel<ArenaQueueChannelType, ArenaQueueChannelType::T1, adl::ArenaQueueExecutor>;
+
+	// Single-thread channel keeps the arena without the lock
+	static_assert(std::is_same_v<Channel_S1::executor_t, adl::BasicQueueExecutor<adl::details::ArenaTaskQueue<false>>>);
+
+	struct alignas(16) Aligned
+	{
+		void operator()() const
+		{
+			assert(reinterpret_cast<std::uintptr_t>(this) % 16 == 0);
+			order->push_back(value);
+		}
+
+		std::vector<size_t>* order;
+		size_t value;
+	};
+
+	// Doesn't fit into a chunk, so it's allocated on the heap
+	struct Large
+	{
+		void operator()() const
+		{
+			order->push_back(value);
+		}
+
+		std::vector<size_t>* order;
+		size_t value;
+		std::array<unsigned char, ADL_TASK_ARENA_CHUNK_SIZE> payload{};
+	};
+}
+
+void test_ArenaQueueExecutor_post()
+{
+	std::vector<size_t> order;
+
+	// Callables of different sizes and alignments are kept in order
+	adl::post<Channel_Q1>([&order] { order.push_back(0); });
+	adl::post<Channel_Q1>(Aligned{ &order, 1 });
+	adl::post_bulk<Channel_Q1>(Large{ &order, 2 }, [&order, value = std::array<size_t, 4>{ 3 }] { order.push_back(value[0]); }, Aligned{ &order, 4 });
+	adl::post_defer<Channel_Q1>([&order] { order.push_back(6); });
+	adl::post<Channel_Q1>([&order] { order.push_back(5); adl::post<Channel_Q1>([&order] { order.push_back(7); }); });
+
+	// Deferred task is executed after the remaining ones by the next dispatch
+	adl::dispatch<Channel_Q1>();
+	assert((order == std::vector<size_t>{ 0, 1, 2, 3, 4, 5, 7 }));
+
+	adl::dispatch<Channel_Q1>();
+	assert((order == std::vector<size_t>{ 0, 1, 2, 3, 4, 5, 7, 6 }));
+
+	// Futures are placed into the arena as well
+	auto future = adl::post_future<Channel_Q1>([] { return size_t{ 8 }; });
+	adl::dispatch<Channel_Q1>();
+	assert(future.get() == 8);
+}
+
+void test_ArenaQueueExecutor_chunks()
+{
+	constexpr size_t TASKS = 10000;
+
+	std::vector<size_t> order;
+	std::vector<size_t> expected;
+
+	// Tasks span many chunks, remaining tasks are kept in order while more tasks are appended
+	for (size_t round = 0; round < 3; ++round)
+	{
+		for (size_t i = 0; i < TASKS; ++i)
+		{
+			const size_t value = expected.size();
+
+			if (i % 3 == 0)
+			{
+				adl::post<Channel_Q2>(Aligned{ &order, value });
+			}
+			else
+			{
+				adl::post<Channel_Q2>([&order, value] { order.push_back(value); });
+			}
+
+			expected.push_back(value);
+		}
+
+		assert(adl::dispatch_n<Channel_Q2>(TASKS / 2) == (round + 1) * TASKS / 2);
+	}
+
+	adl::dispatch<Channel_Q2>();
+	assert(order == expected);
+}
+
+void test_ArenaQueueExecutor_release()
+{
+	auto released = std::make_shared<size_t>(0);
+
+	{
+		// Pending callables are destroyed without invocation
+		adl::details::TaskArena arena;
+
+		for (size_t i = 0; i < 1000; ++i)
+		{
+			arena.emplace_back([released] { ++*released; });
+		}
+
+		arena.emplace_back([released, payload = std::array<unsigned char, ADL_TASK_ARENA_CHUNK_SIZE>{}] { ++*released; });
+		assert(released.use_count() == 1002);
+
+		arena.invoke_front();
+		assert(*released == 1);
+		assert(released.use_count() == 1001);
+	}
+
+	assert(*released == 1);
+	assert(released.use_count() == 1);
+}
+
+void test_ArenaQueueExecutor_throw()
+{
+	auto released = std::make_shared<size_t>(0);
+	adl::details::TaskArena arena;
+
+	arena.emplace_back([released] { throw std::runtime_error{ "arena" }; });
+	arena.emplace_back([released] { ++*released; });
+
+	bool thrown = false;
+
+	try
+	{
+		arena.invoke_front();
+	}
+	catch (const std::runtime_error&)
+	{
+		thrown = true;
+	}
+
+	// Throwing callable is consumed and destroyed, the next one is invoked
+	assert(thrown);
+	assert(arena.size() == 1);
+	assert(released.use_count() == 2);
+
+	arena.invoke_front();
+	assert(arena.empty());
+	assert(*released == 1);
+	assert(released.use_count() == 1);
+
+	// Drained arena is reused
+	arena.emplace_back([released] { ++*released; });
+	arena.invoke_front();
+	assert(*released == 2);
+}
+
+void test_ArenaQueueExecutor_single_thread()
+{
+	std::vector<size_t> order;
+
+	adl::post<Channel_S1>([&order] { order.push_back(0); });
+	adl::post_bulk<Channel_S1>([&order] { order.push_back(1); }, Aligned{ &order, 2 });
+	adl::dispatch<Channel_S1>();
+
+	assert((order == std::vector<size_t>{ 0, 1, 2 }));
+}
+
+void test_ArenaQueueExecutor_threads()
+{
+	constexpr size_t PRODUCERS = 4;
+	constexpr size_t TASKS = 10000;
+
+	std::atomic_size_t counter{ 0 };
+
+	{
+		adl::ChannelThread<Channel_T1> thread;
+		std::vector<std::thread> producers;
+
+		for (size_t i = 0; i < PRODUCERS; ++i)
+		{
+			producers.emplace_back([&counter]
+			{
+				for (size_t task = 0; task < TASKS; ++task)
+				{
+					if (task % 2 == 0)
+					{
+						adl::post<Channel_T1>([&counter] { counter.fetch_add(1, std::memory_order_relaxed); });
+					}
+					else
+					{
+						adl::post<Channel_T1>([&counter, value = std::array<size_t, 4>{ 1 }] { counter.fetch_add(value[0], std::memory_order_relaxed); });
+					}
+				}
+			});
+		}
+
+		for (auto&& producer : producers)
+		{
+			producer.join();
+		}
+
+		while (counter.load() != PRODUCERS * TASKS)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	assert(counter.load() == PRODUCERS * TASKS);
+}
+
+void test_ArenaQueueExecutor()
+{
+	test_ArenaQueueExecutor_post();
+	test_ArenaQueueExecutor_chunks();
+	test_ArenaQueueExecutor_release();
+	test_ArenaQueueExecutor_throw();
+	test_ArenaQueueExecutor_single_thread();
+	test_ArenaQueueExecutor_threads();
+}
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include "test.hpp"
 #include <adl/dispatcher.h>
 #include <adl/executors/async_executor.h>
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
+#include <future>
+#include <thread>
 
 namespace
 {
@@ -49,7 +52,7 @@ void test_AsyncExecutor_post()
 	// Value should be updated
 	assert(get_value<AsyncID>() == AsyncVALUE);
 
-	// Dispatch channel to clear outdated futures in async_executor
+	// Dispatch is not needed for async_executor, but still supported
 	adl::dispatch<Channel_A1>();
 }
 
@@ -88,7 +91,7 @@ void test_AsyncExecutor_post_bulk()
 	assert(get_value<AsyncID2>() == AsyncVALUE);
 	assert(get_value<AsyncID3>() == AsyncVALUE);
 
-	// Dispatch channel to clear outdated futures in async_executor
+	// Dispatch is not needed for async_executor, but still supported
 	adl::dispatch<Channel_A2>();
 }
 
@@ -139,10 +142,43 @@ void test_AsyncExecutor_post_future_bulk()
 	// adl::dispatch<Channel_A4>();
 }
 
+void test_AsyncExecutor_bounded()
+{
+	constexpr size_t TASKS = 1000;
+
+	std::atomic_size_t counter{ 0 };
+
+	{
+		// Executor with only two reusable threads
+		adl::AsyncExecutor executor{ 2 };
+
+		// Tasks should run concurrently, second task unblocks the first one
+		std::promise<void> promise;
+		auto future = promise.get_future();
+
+		executor.execute([&] { future.wait(); ++counter; });
+		executor.execute([&] { promise.set_value(); ++counter; });
+
+		for (size_t i = 2; i < TASKS; ++i)
+		{
+			executor.execute([&] { ++counter; });
+		}
+
+		// Wait for completion of all tasks
+		while (executor.active_tasks() != 0)
+		{
+			std::this_thread::yield();
+		}
+
+		assert(counter == TASKS);
+	}
+}
+
 void test_AsyncExecutor()
 {
 	test_AsyncExecutor_post();
 	test_AsyncExecutor_post_bulk();
 	test_AsyncExecutor_post_future();
 	test_AsyncExecutor_post_future_bulk();
+	test_AsyncExecutor_bounded();
 }
\ No newline at end of file
@@ -0,0 +1,117 @@
+#include "test.hpp"
+#include <adl/channel_thread.h>
+#include <adl/executors/priority_queue_executor.h>
+#include <adl/executors/queue_executor.h>
+#include <adl/executors/strand_executor.h>
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+	enum class ConcurrencyChannelType : int
+	{
+		S1 = 1,
+		P1 = 2,
+		M1 = 3,
+		D1 = 4,
+	};
+
+	using Channel_S1 = adl::Channel<ConcurrencyChannelType, ConcurrencyChannelType::S1, adl::QueueExecutor, adl::Concurrency::SingleThread>;
+	using Channel_P1 = adl::Channel<ConcurrencyChannelType, ConcurrencyChannelType::P1, adl::QueueExecutor, adl::Concurrency::SPSC>;
+	using Channel_M1 = adl::Channel<ConcurrencyChannelType, ConcurrencyChannelType::M1, adl::QueueExecutor, adl::Concurrency::MPSC>;
+	using Channel_D1 = adl::Channel<ConcurrencyChannelType, ConcurrencyChannelType::D1, adl::QueueExecutor>;
+
+	using agent_t = adl::ExecutionAgent<>;
+
+	// Queue is picked by the concurrency, executors without task queues and MPMC channels are used as declared
+	static_assert(std::is_same_v<Channel_S1::executor_t, adl::BasicQueueExecutor<adl::details::UnsyncTaskQueue<agent_t>>>);
+	static_assert(std::is_same_v<Channel_P1::executor_t, adl::BasicQueueExecutor<adl::details::SPSCTaskQueue<agent_t>>>);
+	static_assert(std::is_same_v<Channel_M1::executor_t, adl::LockFreeQueueExecutor>);
+	static_assert(std::is_same_v<Channel_D1::executor_t, adl::QueueExecutor>);
+	static_assert(std::is_same_v<adl::Channel<ConcurrencyChannelType, ConcurrencyChannelType::S1, adl::PriorityQueueExecutor, adl::Concurrency::SingleThread>::executor_t,
+		adl::BasicPriorityQueueExecutor<adl::details::UnsyncTaskQueue<agent_t>>>);
+	static_assert(std::is_same_v<adl::Channel<ConcurrencyChannelType, ConcurrencyChannelType::S1, adl::StrandExecutor, adl::Concurrency::SingleThread>::executor_t, adl::StrandExecutor>);
+}
+
+void test_ChannelConcurrency_single_thread()
+{
+	std::vector<size_t> order;
+
+	adl::post<Channel_S1>([&order] { order.push_back(1); adl::post<Channel_S1>([&order] { order.push_back(3); }); });
+	adl::post_bulk<Channel_S1>([&order] { order.push_back(2); });
+
+	// Tasks posted during the dispatch are executed by it too
+	adl::dispatch<Channel_S1>();
+	assert((order == std::vector<size_t>{ 1, 2, 3 }));
+	assert(adl::dispatch_n<Channel_S1>(0) == 0);
+}
+
+void test_ChannelConcurrency_spsc_queue()
+{
+	// Tasks cross the segments of the ring and drained segments are reused
+	adl::details::SPSCTaskQueue<size_t, 4> queue;
+	std::deque<size_t> batch;
+
+	for (size_t round = 0; round < 3; ++round)
+	{
+		for (size_t i = 0; i < 10; ++i)
+		{
+			queue.emplace(i);
+		}
+
+		queue.emplace_bulk(size_t{ 10 }, size_t{ 11 });
+		assert(!queue.empty());
+
+		queue.pop_all(batch);
+		assert(queue.empty());
+		assert(batch.size() == 12);
+
+		for (size_t i = 0; i < batch.size(); ++i)
+		{
+			assert(batch[i] == i);
+		}
+
+		batch.clear();
+	}
+}
+
+void test_ChannelConcurrency_spsc()
+{
+	// Single producer thread posts to the channel dispatched by the channel thread, order is kept
+	constexpr size_t TASKS = 10000;
+
+	std::atomic_size_t executed{ 0 };
+	size_t next = 0;
+	bool ordered = true;
+
+	{
+		adl::ChannelThread<Channel_P1> thread;
+
+		std::thread producer{ [&]
+		{
+			for (size_t i = 0; i < TASKS; ++i)
+			{
+				adl::post<Channel_P1>([&, i] { ordered = ordered && next++ == i; executed.fetch_add(1); });
+			}
+		} };
+
+		producer.join();
+
+		while (executed.load() != TASKS)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	assert(ordered);
+}
+
+void test_ChannelConcurrency()
+{
+	test_ChannelConcurrency_single_thread();
+	test_ChannelConcurrency_spsc_queue();
+	test_ChannelConcurrency_spsc();
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "test.hpp"
+#include <adl/channel_set.h>
+#include <adl/executors/priority_queue_executor.h>
+#include <adl/executors/queue_executor.h>
+#include <adl/executors/strand_executor.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+	enum class SetChannelType : int
+	{
+		Q1 = 1,
+		Q2 = 2,
+		T1 = 3,
+		T2 = 4,
+		T3 = 5,
+	};
+
+	using Channel_Q1 = adl::Channel<SetChannelType, SetChannelType::Q1, adl::QueueExecutor>;
+	using Channel_Q2 = adl::Channel<SetChannelType, SetChannelType::Q2, adl::QueueExecutor>;
+
+	// Dispatched by the channel set thread
+	using Channel_T1 = adl::Channel<SetChannelType, SetChannelType::T1, adl::LockFreeQueueExecutor>;
+	using Channel_T2 = adl::Channel<SetChannelType, SetChannelType::T2, adl::PriorityQueueExecutor>;
+	using Channel_T3 = adl::Channel<SetChannelType, SetChannelType::T3, adl::StrandExecutor>;
+}
+
+void test_ChannelSet_weights()
+{
+	constexpr size_t TASKS = 4 * ADL_DISPATCH_QUANTUM;
+
+	size_t executed1 = 0;
+	size_t executed2 = 0;
+
+	// Idle channels are skipped
+	assert((!adl::dispatch_all<Channel_Q1, Channel_Q2>()));
+
+	for (size_t i = 0; i < TASKS; ++i)
+	{
+		adl::post<Channel_Q1>([&executed1] { ++executed1; });
+		adl::post<Channel_Q2>([&executed2] { ++executed2; });
+	}
+
+	// Every channel dispatches its quantum per round
+	adl::ChannelSet<Channel_Q1, Channel_Q2> set;
+	set.set_weight<Channel_Q2>(2);
+
+	assert(set.dispatch());
+	assert(executed1 == ADL_DISPATCH_QUANTUM);
+	assert(executed2 == 2 * ADL_DISPATCH_QUANTUM);
+
+	// Channel with zero weight is excluded
+	set.set_weight<Channel_Q1>(0);
+
+	assert(!set.dispatch());
+	assert(executed1 == ADL_DISPATCH_QUANTUM);
+	assert(executed2 == TASKS);
+
+	assert((adl::dispatch_all<Channel_Q1, Channel_Q2>()));
+	assert(executed1 == 2 * ADL_DISPATCH_QUANTUM);
+
+	while (adl::dispatch_all<Channel_Q1, Channel_Q2>()) {}
+	assert(executed1 == TASKS);
+}
+
+void test_ChannelSet_park()
+{
+	using set_t = adl::ChannelSet<Channel_T1, Channel_T2, Channel_T3>;
+	static_assert(set_t::can_park);
+
+	adl::stop_source stop;
+	std::thread thread{ [token = stop.get_token()] { set_t{}.run_until(token); } };
+
+	// Parked thread is woken by any of the channels
+	std::atomic_size_t executed{ 0 };
+
+	for (size_t i = 0; i < 100; ++i)
+	{
+		adl::post<Channel_T1>([&executed] { executed.fetch_add(1); });
+		std::this_thread::sleep_for(std::chrono::microseconds{ 10 });
+		adl::post<Channel_T2>([&executed] { executed.fetch_add(1); });
+		std::this_thread::sleep_for(std::chrono::microseconds{ 10 });
+		adl::post<Channel_T3>([&executed] { executed.fetch_add(1); });
+
+		while (executed.load() != (i + 1) * 3)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	stop.request_stop();
+	thread.join();
+}
+
+void test_ChannelSet()
+{
+	test_ChannelSet_weights();
+	test_ChannelSet_park();
+}
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "test.hpp"
+#include <adl/channel_thread.h>
+#include <adl/executors/queue_executor.h>
+#include <adl/executors/strand_executor.h>
+#include <atomic>
+#include <thread>
+
+namespace
+{
+	enum class ThreadChannelType : int
+	{
+		Q1 = 1,
+		Q2 = 2,
+		L1 = 3,
+		S1 = 4,
+		Q3 = 5,
+	};
+
+	using Channel_Q1 = adl::Channel<ThreadChannelType, ThreadChannelType::Q1, adl::QueueExecutor>;
+	using Channel_Q2 = adl::Channel<ThreadChannelType, ThreadChannelType::Q2, adl::QueueExecutor>;
+	using Channel_L1 = adl::Channel<ThreadChannelType, ThreadChannelType::L1, adl::LockFreeQueueExecutor>;
+	using Channel_S1 = adl::Channel<ThreadChannelType, ThreadChannelType::S1, adl::StrandExecutor>;
+	using Channel_Q3 = adl::Channel<ThreadChannelType, ThreadChannelType::Q3, adl::QueueExecutor>;
+
+	// Task defers itself while the flag is set
+	struct RedeferTask
+	{
+		void operator()() const
+		{
+			if (redefer->load())
+			{
+				adl::post_defer<Channel_Q3>(*this);
+			}
+			else
+			{
+				done->store(true);
+			}
+		}
+
+		std::atomic_bool* redefer;
+		std::atomic_bool* done;
+	};
+
+	// Task hops between channels until the hops are over
+	template<typename ChannelType, typename NextChannelType>
+	struct HopTask
+	{
+		void operator()() const
+		{
+			if (hops > 0)
+			{
+				adl::post<NextChannelType>(HopTask<NextChannelType, ChannelType>{ counter, hops - 1 });
+			}
+			else
+			{
+				counter->fetch_add(1);
+			}
+		}
+
+		std::atomic_size_t* counter;
+		size_t hops;
+	};
+}
+
+void test_ChannelThread_wait()
+{
+	for (adl::WaitStrategy wait : { adl::WaitStrategy::Spin, adl::WaitStrategy::Yield, adl::WaitStrategy::Park })
+	{
+		adl::ChannelThreadOptions options;
+		options.wait = wait;
+		options.name = "adl-test";
+		options.affinity = 1;
+
+		adl::ChannelThread<Channel_Q1> thread{ options };
+
+		// Tasks are executed by the channel thread
+		for (size_t i = 0; i < 100; ++i)
+		{
+			assert(adl::post_future<Channel_Q1>([] { return std::this_thread::get_id(); }).get() == thread.get_id());
+		}
+	}
+}
+
+void test_ChannelThread_channels()
+{
+	adl::ChannelThread<Channel_L1, Channel_S1> thread;
+
+	auto future1 = adl::post_future<Channel_L1>([] { return std::this_thread::get_id(); });
+	auto future2 = adl::post_future<Channel_S1>([] { return std::this_thread::get_id(); });
+
+	assert(future1.get() == thread.get_id());
+	assert(future2.get() == thread.get_id());
+}
+
+void test_ChannelThread_drain()
+{
+	constexpr size_t TASKS = 1000;
+	constexpr size_t HOPS = 8;
+
+	std::atomic_size_t counter{ 0 };
+
+	{
+		adl::ChannelThread<Channel_Q2, Channel_S1> thread;
+
+		for (size_t i = 0; i < TASKS; ++i)
+		{
+			adl::post<Channel_Q2>(HopTask<Channel_Q2, Channel_S1>{ &counter, HOPS });
+		}
+	}
+
+	// Stopped thread executes all tasks, including the ones posted by other channel
+	assert(counter.load() == TASKS);
+
+	// Stopped thread doesn't dispatch anymore
+	adl::ChannelThread<Channel_Q2> thread;
+	thread.stop();
+
+	adl::post<Channel_Q2>([&counter] { counter.store(0); });
+	assert(counter.load() == TASKS);
+
+	adl::dispatch<Channel_Q2>();
+	assert(counter.load() == 0);
+}
+
+void test_ChannelThread_drain_deferred()
+{
+	std::atomic_bool redefer{ true };
+	std::atomic_bool done{ false };
+
+	// Stop returns although the task defers itself on every pass
+	{
+		adl::ChannelThread<Channel_Q3> thread;
+		adl::post<Channel_Q3>(RedeferTask{ &redefer, &done });
+	}
+
+	// Deferred task is left in the channel for the next dispatch
+	assert(!done.load());
+	assert(adl::get_executor<Channel_Q3>().has_tasks());
+
+	redefer.store(false);
+	adl::dispatch<Channel_Q3>();
+
+	assert(done.load());
+	assert(!adl::get_executor<Channel_Q3>().has_tasks());
+}
+
+void test_ChannelThread()
+{
+	test_ChannelThread_wait();
+	test_ChannelThread_channels();
+	test_ChannelThread_drain();
+	test_ChannelThread_drain_deferred();
+}
\ No newline at end of file
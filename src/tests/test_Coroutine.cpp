@@ -0,0 +1,178 @@
+#include "test.hpp"
+#include <adl/coroutine.h>
+
+// Coroutines are tested only by the C++20 build of the tests
+#if ADL_HAS_COROUTINES
+#include <adl/channel_thread.h>
+#include <adl/when_all.h>
+#include <adl/executors/queue_executor.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <tuple>
+
+namespace
+{
+	enum class CoroutineChannelType : int
+	{
+		Q1 = 1,
+		Q2 = 2,
+		J = 3,
+		T1 = 4,
+		T2 = 5,
+	};
+
+	using Channel_Q1 = adl::Channel<CoroutineChannelType, CoroutineChannelType::Q1, adl::QueueExecutor>;
+	using Channel_Q2 = adl::Channel<CoroutineChannelType, CoroutineChannelType::Q2, adl::QueueExecutor>;
+	using Channel_J = adl::Channel<CoroutineChannelType, CoroutineChannelType::J, adl::QueueExecutor>;
+
+	// Dispatched in separate threads
+	using Channel_T1 = adl::Channel<CoroutineChannelType, CoroutineChannelType::T1, adl::LockFreeQueueExecutor>;
+	using Channel_T2 = adl::Channel<CoroutineChannelType, CoroutineChannelType::T2, adl::LockFreeQueueExecutor>;
+
+	adl::co_task<size_t> hop(std::string& order)
+	{
+		co_await adl::schedule<Channel_Q1>();
+		order += '1';
+
+		co_await adl::schedule<Channel_Q2>();
+		order += '2';
+
+		// Already in the channel, the coroutine isn't suspended
+		co_await adl::schedule<Channel_Q2>();
+		order += '3';
+
+		co_return order.size();
+	}
+
+	adl::co_task<> await_hop(std::string& order, size_t& result)
+	{
+		result = co_await hop(order);
+	}
+
+	adl::co_task<> await_tasks(size_t& result, bool& completed)
+	{
+		const size_t value = co_await adl::task<Channel_Q1>(&generate<5>).then<Channel_Q2>(&add<2>);
+		co_await adl::task<Channel_Q1>([&result, value] { result = value; });
+
+		const auto [first, second] = co_await adl::when_all<Channel_J>(adl::task<Channel_Q1>(&generate<1>), adl::task<Channel_Q2>(&generate<2>));
+		result += first + second;
+
+		completed = true;
+	}
+
+	adl::co_task<> await_future(adl::future<size_t> future, size_t& result)
+	{
+		result = co_await std::move(future);
+		result += co_await adl::make_ready_future(size_t{ 10 });
+		co_await adl::make_ready_future();
+	}
+
+	adl::co_task<> ping_pong(size_t hops, std::atomic_size_t& completed)
+	{
+		for (size_t i = 0; i < hops; ++i)
+		{
+			co_await adl::schedule<Channel_T1>();
+			co_await adl::schedule<Channel_T2>();
+		}
+
+		completed.fetch_add(1);
+	}
+}
+
+void test_Coroutine_schedule()
+{
+	std::string order;
+	size_t result = 0;
+
+	// Coroutine isn't started until submitted
+	auto coroutine = await_hop(order, result);
+	assert(order.empty());
+
+	std::move(coroutine).submit();
+	assert(order.empty());
+
+	adl::dispatch<Channel_Q1>();
+	assert(order == "1");
+
+	adl::dispatch<Channel_Q2>();
+	assert(order == "123");
+	assert(result == 3);
+
+	// Coroutine is started in the channel
+	order.clear();
+	await_hop(order, result).submit<Channel_Q2>();
+	adl::dispatch<Channel_Q2>();
+	adl::dispatch<Channel_Q1>();
+	adl::dispatch<Channel_Q2>();
+	assert(order == "123");
+}
+
+void test_Coroutine_await()
+{
+	{
+		// Tasks are submitted when awaited, the coroutine is resumed by their last continuation
+		size_t result = 0;
+		bool completed = false;
+
+		await_tasks(result, completed).submit();
+
+		adl::dispatch<Channel_Q1>();
+		adl::dispatch<Channel_Q2>();
+		adl::dispatch<Channel_Q1>();
+		assert(result == 7);
+
+		adl::dispatch<Channel_Q1>();
+		adl::dispatch<Channel_Q2>();
+		assert(!completed);
+
+		adl::dispatch<Channel_J>();
+		assert(completed);
+		assert(result == 10);
+	}
+
+	{
+		// Coroutine is resumed by the thread which sets the value
+		adl::promise<size_t> promise;
+		size_t result = 0;
+
+		await_future(promise.get_future(), result).submit();
+		assert(result == 0);
+
+		promise.set_value(5);
+		assert(result == 15);
+	}
+}
+
+void test_Coroutine_threads()
+{
+	constexpr size_t COROUTINES = 64;
+	constexpr size_t HOPS = 100;
+
+	adl::ChannelThread<Channel_T1> t1;
+	adl::ChannelThread<Channel_T2> t2;
+
+	std::atomic_size_t completed{ 0 };
+
+	for (size_t i = 0; i < COROUTINES; ++i)
+	{
+		ping_pong(HOPS, completed).submit();
+	}
+
+	while (completed.load() != COROUTINES)
+	{
+		std::this_thread::yield();
+	}
+}
+
+void test_Coroutine()
+{
+	test_Coroutine_schedule();
+	test_Coroutine_await();
+	test_Coroutine_threads();
+}
+#else
+void test_Coroutine()
+{
+}
+#endif
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "test.hpp"
+#include <adl/dispatcher.h>
+#include <adl/executors/execution_agent.h>
+#include <adl/executors/queue_executor.h>
+#include <adl/executors/strand_executor.h>
+#include <memory>
+
+namespace
+{
+	enum class AgentChannelType : int
+	{
+		Q1 = 1,
+		S1 = 2,
+	};
+
+	using Channel_Q1 = adl::Channel<AgentChannelType, AgentChannelType::Q1, adl::QueueExecutor>;
+	using Channel_S1 = adl::Channel<AgentChannelType, AgentChannelType::S1, adl::StrandExecutor>;
+
+	template<size_t size>
+	struct SizedCallable
+	{
+		void operator()() { ValueHolder<size>::value = data[0] + 1; }
+
+		size_t data[size / sizeof(size_t)] = {};
+	};
+}
+
+void test_ExecutionAgent_storage()
+{
+	using Agent = adl::ExecutionAgent<>;
+
+	// Function pointers and small lambdas are stored inline
+	static_assert(Agent::is_stored_inline_v<void(*)()>);
+	static_assert(Agent::is_stored_inline_v<SizedCallable<Agent::inline_size>>);
+	// Callables bigger than the inline buffer are allocated on the heap
+	static_assert(!Agent::is_stored_inline_v<SizedCallable<Agent::inline_size + sizeof(size_t)>>);
+
+	constexpr size_t SMALL = Agent::inline_size;
+	constexpr size_t BIG = Agent::inline_size + sizeof(size_t);
+
+	reset_values<SMALL, BIG>();
+
+	Agent small{ SizedCallable<SMALL>{} };
+	Agent big{ SizedCallable<BIG>{} };
+
+	// Agents should keep callables after move
+	Agent movedSmall = std::move(small);
+	Agent movedBig = std::move(big);
+
+	assert(!small);
+	assert(!big);
+
+	movedSmall();
+	movedBig();
+
+	assert(get_value<SMALL>() == 1);
+	assert(get_value<BIG>() == 1);
+}
+
+void test_ExecutionAgent_move_only()
+{
+	constexpr size_t ID = __LINE__;
+	constexpr size_t ID2 = __LINE__;
+	constexpr size_t VALUE = __LINE__;
+
+	reset_values<ID, ID2>();
+
+	// Move-only callables can be posted to the queued executors
+	adl::post<Channel_Q1>([value = std::make_unique<size_t>(VALUE)] { set_a<ID>(*value); });
+	adl::post<Channel_S1>([value = std::make_unique<size_t>(VALUE)] { set_a<ID2>(*value); });
+
+	adl::dispatch<Channel_Q1>();
+	adl::dispatch<Channel_S1>();
+
+	assert(get_value<ID>() == VALUE);
+	assert(get_value<ID2>() == VALUE);
+}
+
+void test_ExecutionAgent_destroy()
+{
+	auto counter = std::make_shared<size_t>(0);
+
+	{
+		// Callable should be destroyed once with the agent
+		adl::ExecutionAgent<> agent{ [counter] { ++(*counter); } };
+		assert(counter.use_count() == 2);
+
+		adl::ExecutionAgent<> moved = std::move(agent);
+		assert(counter.use_count() == 2);
+
+		moved();
+		assert(*counter == 1);
+	}
+
+	assert(counter.use_count() == 1);
+}
+
+void test_ExecutionAgent()
+{
+	test_ExecutionAgent_storage();
+	test_ExecutionAgent_move_only();
+	test_ExecutionAgent_destroy();
+}
\ No newline at end of file
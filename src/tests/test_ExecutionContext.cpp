@@ -54,8 +54,8 @@ namespace
 	template<size_t ID>
 	size_t set_and_return(size_t value)
 	{
-		ValueHolder::value = value;
-		return ValueHolder::value;
+		ValueHolder<ID>::value = value;
+		return ValueHolder<ID>::value;
 	}
 
 	constexpr size_t ID = __LINE__;
@@ -0,0 +1,92 @@
+#include "test.hpp"
+#include "test_ExecutorRegistry.hpp"
+#include <string>
+
+namespace
+{
+	enum class RegistryChannelType : int
+	{
+		E1 = 1,
+		E2 = 2,
+	};
+
+	std::string& lifetime_log()
+	{
+		static std::string log;
+		return log;
+	}
+
+	// Records construction and destruction of the executor
+	template<char ID>
+	class LoggingExecutor : public adl::QueueExecutor
+	{
+	public:
+
+		LoggingExecutor()
+		{
+			lifetime_log() += '+';
+			lifetime_log() += ID;
+		}
+
+		~LoggingExecutor()
+		{
+			lifetime_log() += '-';
+			lifetime_log() += ID;
+		}
+	};
+
+	using Channel_E1 = adl::Channel<RegistryChannelType, RegistryChannelType::E1, LoggingExecutor<'1'>>;
+	using Channel_E2 = adl::Channel<RegistryChannelType, RegistryChannelType::E2, LoggingExecutor<'2'>>;
+}
+
+void test_ExecutorRegistry_shared()
+{
+	using namespace registry_test;
+
+	// Executor of the channel is the same in all translation units
+	assert(&adl::get_executor<Channel_Shared>() == shared_executor());
+
+	reset_value<REGISTRY_VALUE_ID>();
+	post_shared(5);
+	assert(get_value<REGISTRY_VALUE_ID>() == 0);
+
+	adl::dispatch<Channel_Shared>();
+	assert(get_value<REGISTRY_VALUE_ID>() == 5);
+}
+
+void test_ExecutorRegistry_order()
+{
+	// Executors are constructed before main
+	adl::get_executor<Channel_E1>();
+	adl::get_executor<Channel_E2>();
+
+	adl::destroy_executors<Channel_E1, Channel_E2>();
+
+	lifetime_log().clear();
+
+	{
+		adl::ExecutorScope<Channel_E2, Channel_E1> scope;
+		assert(lifetime_log() == "+2+1");
+
+		// Constructed executors are skipped
+		adl::construct_executors<Channel_E1>();
+		assert(lifetime_log() == "+2+1");
+
+		size_t executed = 0;
+		adl::post<Channel_E1>([&executed] { ++executed; });
+		adl::dispatch<Channel_E1>();
+		assert(executed == 1);
+	}
+
+	assert(lifetime_log() == "+2+1-1-2");
+
+	// Destroyed executors are not destroyed again at exit
+	adl::destroy_executors<Channel_E1>();
+	assert(lifetime_log() == "+2+1-1-2");
+}
+
+void test_ExecutorRegistry()
+{
+	test_ExecutorRegistry_shared();
+	test_ExecutorRegistry_order();
+}
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+#include <adl/dispatcher.h>
+#include <adl/executors/queue_executor.h>
+#include <cstddef>
+
+// Channel shared by the translation units of the registry tests
+namespace registry_test
+{
+	enum class SharedChannelType : int
+	{
+		Shared = 1,
+	};
+
+	using Channel_Shared = adl::Channel<SharedChannelType, SharedChannelType::Shared, adl::QueueExecutor>;
+
+	// Value set by the agents posted to the shared channel
+	constexpr size_t REGISTRY_VALUE_ID = 210;
+
+	// Defined in another translation unit
+	void post_shared(size_t value);
+	adl::QueueExecutor* shared_executor();
+}
\ No newline at end of file
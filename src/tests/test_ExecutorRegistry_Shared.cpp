@@ -0,0 +1,15 @@
+#include "test.hpp"
+#include "test_ExecutorRegistry.hpp"
+
+namespace registry_test
+{
+	void post_shared(size_t value)
+	{
+		adl::post<Channel_Shared>([value] { ValueHolder<REGISTRY_VALUE_ID>::value = value; });
+	}
+
+	adl::QueueExecutor* shared_executor()
+	{
+		return &adl::get_executor<Channel_Shared>();
+	}
+}
\ No newline at end of file
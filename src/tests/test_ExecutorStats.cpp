@@ -0,0 +1,135 @@
+#include "test.hpp"
+#include <adl/dispatcher.h>
+#include <adl/executors/queue_executor.h>
+#include <adl/executors/strand_executor.h>
+#include <adl/executors/thread_pool_executor.h>
+#include <thread>
+
+namespace
+{
+	enum class StatsChannelType : int
+	{
+		Q1 = 1,
+		S1 = 2,
+		P1 = 3,
+	};
+
+	using Channel_Q1 = adl::Channel<StatsChannelType, StatsChannelType::Q1, adl::QueueExecutor>;
+	using Channel_S1 = adl::Channel<StatsChannelType, StatsChannelType::S1, adl::StrandExecutor>;
+	using Channel_P1 = adl::Channel<StatsChannelType, StatsChannelType::P1, adl::ThreadPoolExecutor>;
+
+	constexpr bool STATS_ENABLED = ADL_EXECUTOR_STATS;
+}
+
+void test_ExecutorStats_queue()
+{
+	constexpr size_t ID = __LINE__;
+
+	adl::post<Channel_Q1>(&reset_values<ID>);
+	adl::post_bulk<Channel_Q1>(&reset_values<ID>, &reset_values<ID>);
+	adl::post_defer<Channel_Q1>(&reset_values<ID>);
+
+	adl::ExecutorStats stats = adl::stats<Channel_Q1>();
+
+	if constexpr (STATS_ENABLED)
+	{
+		assert(stats.posted == 4);
+		assert(stats.deferred == 1);
+		assert(stats.queue_depth == 4);
+		assert(stats.max_queue_depth == 4);
+		assert(stats.executed == 0);
+	}
+
+	adl::dispatch<Channel_Q1>();
+	stats = adl::stats<Channel_Q1>();
+
+	if constexpr (STATS_ENABLED)
+	{
+		// Deferred task is executed on the next dispatch
+		assert(stats.executed == 3);
+		assert(stats.queue_depth == 1);
+		assert(stats.dispatches == 1);
+	}
+
+	adl::dispatch<Channel_Q1>();
+	stats = adl::stats<Channel_Q1>();
+
+	if constexpr (STATS_ENABLED)
+	{
+		assert(stats.executed == 4);
+		assert(stats.queue_depth == 0);
+		assert(stats.max_queue_depth == 4);
+		assert(stats.dispatches == 2);
+	}
+	else
+	{
+		assert(stats.posted == 0 && stats.executed == 0 && stats.dispatches == 0);
+	}
+}
+
+void test_ExecutorStats_strand()
+{
+	constexpr size_t ID = __LINE__;
+
+	adl::post_bulk<Channel_S1>(&reset_values<ID>, &reset_values<ID>);
+	adl::dispatch<Channel_S1>();
+
+	const adl::ExecutorStats stats = adl::stats<Channel_S1>();
+
+	if constexpr (STATS_ENABLED)
+	{
+		assert(stats.posted == 2);
+		assert(stats.executed == 2);
+		assert(stats.max_queue_depth == 2);
+		assert(stats.dispatches == 1);
+	}
+}
+
+void test_ExecutorStats_thread_pool()
+{
+	constexpr size_t ID = __LINE__;
+
+	auto future = adl::post_future<Channel_P1>(&reset_values<ID>);
+	future.get();
+
+	if constexpr (STATS_ENABLED)
+	{
+		// Task is counted as executed after it returns
+		while (adl::stats<Channel_P1>().executed != 1)
+		{
+			std::this_thread::yield();
+		}
+
+		const adl::ExecutorStats stats = adl::stats<Channel_P1>();
+
+		assert(stats.posted == 1);
+		assert(stats.queue_depth == 0);
+	}
+}
+
+void test_ExecutorStats_inline()
+{
+	constexpr size_t ID = __LINE__;
+
+	const adl::ExecutorStats before = adl::stats<void>();
+
+	adl::post<void>(&reset_values<ID>);
+	adl::post_bulk<void>(&reset_values<ID>, &reset_values<ID>);
+
+	const adl::ExecutorStats after = adl::stats<void>();
+
+	if constexpr (STATS_ENABLED)
+	{
+		assert(after.posted - before.posted == 3);
+		assert(after.executed - before.executed == 3);
+		assert(after.queue_depth == 0);
+	}
+}
+
+void test_ExecutorStats()
+{
+	test_ExecutorStats_queue();
+	test_ExecutorStats_strand();
+	test_ExecutorStats_thread_pool();
+	test_ExecutorStats_inline();
+}
\ No newline at end of file
@@ -0,0 +1,257 @@
+#include "test.hpp"
+#include <adl/dispatcher.h>
+#include <adl/future.h>
+#include <adl/executors/queue_executor.h>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace
+{
+	enum class FutureChannelType : int
+	{
+		Q1 = 1,
+		Q2 = 2,
+	};
+
+	using Channel_Q1 = adl::Channel<FutureChannelType, FutureChannelType::Q1, adl::QueueExecutor>;
+	using Channel_Q2 = adl::Channel<FutureChannelType, FutureChannelType::Q2, adl::QueueExecutor>;
+}
+
+void test_Future_ready()
+{
+	constexpr size_t VALUE = __LINE__;
+
+	// Ready future holds the value inline
+	adl::future<size_t> future = adl::make_ready_future(VALUE);
+
+	assert(future.valid());
+	assert(future.is_ready());
+	assert(future.get() == VALUE);
+	assert(!future.valid());
+
+	adl::future<void> voidFuture = adl::make_ready_future();
+
+	assert(voidFuture.is_ready());
+	voidFuture.get();
+	assert(!voidFuture.valid());
+}
+
+void test_Future_promise()
+{
+	constexpr size_t VALUE = __LINE__;
+
+	adl::promise<std::unique_ptr<size_t>> promise;
+	adl::future<std::unique_ptr<size_t>> future = promise.get_future();
+
+	assert(future.valid());
+	assert(!future.is_ready());
+
+	// Move-only values are passed through the shared state
+	promise.set_value(std::make_unique<size_t>(VALUE));
+
+	assert(future.is_ready());
+	assert(*future.get() == VALUE);
+}
+
+void test_Future_wait()
+{
+	constexpr size_t VALUE = __LINE__;
+
+	adl::promise<size_t> promise;
+	adl::future<size_t> future = promise.get_future();
+
+	// Consumer is parked until the value is set by another thread
+	std::thread producer{ [&, promise = std::move(promise)]() mutable
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+		promise.set_value(VALUE);
+	} };
+
+	assert(future.get() == VALUE);
+	producer.join();
+}
+
+void test_Future_post_future()
+{
+	constexpr size_t ID = __LINE__;
+	constexpr size_t VALUE = __LINE__;
+
+	reset_values<ID>();
+	set_value<ID, VALUE>();
+
+	// Executors return adl::future
+	adl::future<size_t> future = adl::post_future<Channel_Q1>(&get_value<ID>);
+	adl::future<void> voidFuture = adl::post_future<Channel_Q1>(&reset_values<ID>);
+
+	assert(!future.is_ready());
+	assert(!voidFuture.is_ready());
+
+	adl::dispatch<Channel_Q1>();
+
+	assert(future.get() == VALUE);
+	voidFuture.get();
+	assert(get_value<ID>() == 0);
+}
+
+void test_Future_then()
+{
+	constexpr size_t ID = __LINE__;
+	constexpr size_t VALUE = __LINE__;
+	constexpr size_t ADD = __LINE__;
+
+	reset_values<ID>();
+	set_value<ID, VALUE>();
+
+	// Continuation is posted to the second channel when the first one is dispatched
+	adl::future<size_t> future = adl::post_future<Channel_Q1>(&get_value<ID>)
+		.then<Channel_Q2>(&add<ADD>)
+		.then<Channel_Q2>([](size_t value) { return value + ADD; });
+
+	assert(future.valid());
+
+	adl::dispatch<Channel_Q2>();
+	assert(!future.is_ready());
+
+	adl::dispatch<Channel_Q1>();
+	assert(!future.is_ready());
+
+	adl::dispatch<Channel_Q2>();
+	assert(future.is_ready());
+	assert(future.get() == VALUE + ADD + ADD);
+}
+
+void test_Future_then_ready()
+{
+	constexpr size_t ID = __LINE__;
+	constexpr size_t VALUE = __LINE__;
+
+	reset_values<ID>();
+
+	// Continuation of the ready future is posted right away
+	adl::future<void> future = adl::make_ready_future(VALUE).then<Channel_Q1>(&set_a<ID>);
+
+	assert(!future.is_ready());
+
+	adl::dispatch<Channel_Q1>();
+
+	assert(future.is_ready());
+	assert(get_value<ID>() == VALUE);
+
+	// Continuation of the void future is invoked without arguments
+	adl::future<size_t> voidFuture = adl::make_ready_future().then<void>(&generate<VALUE>);
+
+	assert(voidFuture.is_ready());
+	assert(voidFuture.get() == VALUE);
+}
+
+void test_Future_then_broken()
+{
+	constexpr size_t ID = __LINE__;
+
+	reset_values<ID>();
+
+	adl::future<void> future;
+
+	{
+		adl::promise<size_t> promise;
+		future = promise.get_future().then<Channel_Q1>(&set_a<ID>);
+	}
+
+	adl::dispatch<Channel_Q1>();
+
+	// Continuation of the broken promise is not invoked
+	assert(future.is_ready());
+	assert(get_value<ID>() == 0);
+}
+
+void test_Future_broken()
+{
+	{
+		// Dropped promise is a recoverable error
+		adl::future<size_t> future;
+
+		{
+			adl::promise<size_t> promise;
+			future = promise.get_future();
+		}
+
+		assert(future.is_ready());
+
+		bool broken = false;
+
+		try
+		{
+			future.get();
+		}
+		catch (const std::future_error& error)
+		{
+			broken = error.code() == std::future_errc::broken_promise;
+		}
+
+		assert(broken);
+		assert(!future.valid());
+	}
+
+	{
+		// Task which throws drops its promise
+		auto future = adl::post_future<Channel_Q1>([]() -> size_t { throw std::runtime_error{ "task failed" }; });
+
+		bool failed = false;
+
+		try
+		{
+			adl::dispatch<Channel_Q1>();
+		}
+		catch (const std::runtime_error&)
+		{
+			failed = true;
+		}
+
+		assert(failed);
+
+		bool broken = false;
+
+		try
+		{
+			future.get();
+		}
+		catch (const std::future_error& error)
+		{
+			broken = error.code() == std::future_errc::broken_promise;
+		}
+
+		assert(broken);
+	}
+}
+
+void test_Future_then_thread()
+{
+	constexpr size_t VALUE = __LINE__;
+
+	adl::promise<size_t> promise;
+	adl::future<size_t> future = promise.get_future().then<Channel_Q1>([](size_t value) { return value; });
+
+	// Value set by another thread posts the continuation
+	std::thread producer{ [&, promise = std::move(promise)]() mutable { promise.set_value(VALUE); } };
+	producer.join();
+
+	adl::dispatch<Channel_Q1>();
+
+	assert(future.get() == VALUE);
+}
+
+void test_Future()
+{
+	test_Future_ready();
+	test_Future_promise();
+	test_Future_wait();
+	test_Future_post_future();
+	test_Future_then();
+	test_Future_then_ready();
+	test_Future_then_broken();
+	test_Future_broken();
+	test_Future_then_thread();
+}
\ No newline at end of file
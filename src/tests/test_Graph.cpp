@@ -0,0 +1,200 @@
+#include "test.hpp"
+#include <adl/graph.h>
+#include <adl/channel_thread.h>
+#include <adl/executors/queue_executor.h>
+#include <atomic>
+#include <string>
+
+namespace
+{
+	enum class GraphChannelType : int
+	{
+		Q1 = 1,
+		Q2 = 2,
+		T1 = 3,
+		T2 = 4,
+	};
+
+	using Channel_Q1 = adl::Channel<GraphChannelType, GraphChannelType::Q1, adl::QueueExecutor>;
+	using Channel_Q2 = adl::Channel<GraphChannelType, GraphChannelType::Q2, adl::QueueExecutor>;
+
+	// Dispatched in separate threads
+	using Channel_T1 = adl::Channel<GraphChannelType, GraphChannelType::T1, adl::LockFreeQueueExecutor>;
+	using Channel_T2 = adl::Channel<GraphChannelType, GraphChannelType::T2, adl::LockFreeQueueExecutor>;
+}
+
+void test_Graph_diamond()
+{
+	std::string order;
+
+	adl::graph graph;
+
+	const auto a = graph.node<Channel_Q1>([&order] { order += 'a'; });
+	const auto b = graph.node<Channel_Q2>([&order] { order += 'b'; });
+	const auto c = graph.node<Channel_Q2>([&order] { order += 'c'; });
+	const auto d = graph.node<Channel_Q1>([&order] { order += 'd'; });
+
+	graph.precede(a, b);
+	graph.precede(a, c);
+	graph.precede(b, d);
+	graph.precede(c, d);
+
+	assert(graph.compile());
+	assert(graph.size() == 4);
+
+	// Graph is launched repeatedly without recompilation
+	for (size_t launch = 0; launch < 3; ++launch)
+	{
+		order.clear();
+
+		graph.launch();
+		assert(!graph.done());
+
+		assert(adl::dispatch_n<Channel_Q1>(1) == 0);
+		assert(order == "a");
+
+		// Nodes made ready by the same node are posted to their channel together, one agent per node
+		assert(adl::dispatch_n<Channel_Q2>(1) == 1);
+		assert(order == "ab");
+
+		assert(adl::dispatch_n<Channel_Q2>(1) == 0);
+		assert(order == "abc");
+		assert(!graph.done());
+
+		adl::dispatch<Channel_Q1>();
+		assert(order == "abcd");
+		assert(graph.done());
+	}
+}
+
+void test_Graph_roots()
+{
+	// Nodes without predecessors are posted by the launch, nodes without channel are executed inline
+	size_t executed = 0;
+
+	adl::graph graph;
+
+	const auto a = graph.node<Channel_Q1>([&executed] { ++executed; });
+	const auto b = graph.node<Channel_Q1>([&executed] { ++executed; });
+	const auto c = graph.node<void>([&executed] { ++executed; });
+	const auto d = graph.node<Channel_Q2>([&executed] { ++executed; });
+
+	graph.precede(a, d);
+	graph.precede(b, d);
+	graph.precede(c, d);
+
+	// Graph is compiled by the first launch
+	graph.launch();
+	assert(executed == 1);
+
+	assert(adl::dispatch_n<Channel_Q1>(1) == 1);
+	assert(executed == 2);
+
+	assert(adl::dispatch_n<Channel_Q1>(1) == 0);
+	assert(executed == 3);
+
+	adl::dispatch<Channel_Q2>();
+	assert(executed == 4);
+	assert(graph.done());
+
+	// Empty graph is completed immediately
+	adl::graph empty;
+	empty.launch();
+	assert(empty.done());
+}
+
+void test_Graph_fan_out()
+{
+	// Ready nodes are separate agents, so every node can be taken by another worker
+	constexpr size_t WIDTH = 6;
+
+	size_t executed = 0;
+
+	adl::graph graph;
+
+	const auto root = graph.node<Channel_Q1>([&executed] { ++executed; });
+
+	for (size_t i = 0; i < WIDTH; ++i)
+	{
+		graph.precede(root, graph.node<Channel_Q1>([&executed] { ++executed; }));
+	}
+
+	graph.launch();
+
+	assert(adl::dispatch_n<Channel_Q1>(1) == WIDTH);
+	assert(executed == 1);
+
+	for (size_t i = 1; i <= WIDTH; ++i)
+	{
+		assert(!graph.done());
+		assert(adl::dispatch_n<Channel_Q1>(1) == WIDTH - i);
+		assert(executed == i + 1);
+	}
+
+	assert(graph.done());
+}
+
+void test_Graph_cycle()
+{
+	adl::graph graph;
+
+	const auto a = graph.node<Channel_Q1>([] {});
+	const auto b = graph.node<Channel_Q1>([] {});
+	const auto c = graph.node<Channel_Q1>([] {});
+
+	graph.precede(a, b);
+	graph.precede(b, c);
+	graph.precede(c, b);
+
+	assert(!graph.compile());
+}
+
+void test_Graph_threads()
+{
+	// Fan out to both channel threads and join, the launching thread waits for the completion
+	constexpr size_t WIDTH = 32;
+	constexpr size_t LAUNCHES = 200;
+
+	adl::ChannelThread<Channel_T1> t1;
+	adl::ChannelThread<Channel_T2> t2;
+
+	std::atomic_size_t executed{ 0 };
+	size_t joined = 0;
+
+	adl::graph graph;
+
+	const auto root = graph.node<Channel_T1>([&executed] { executed.fetch_add(1); });
+	const auto join = graph.node<Channel_T2>([&executed, &joined] { joined += executed.load(); });
+
+	for (size_t i = 0; i < WIDTH; ++i)
+	{
+		const auto node = i % 2 == 0
+			? graph.node<Channel_T1>([&executed] { executed.fetch_add(1); })
+			: graph.node<Channel_T2>([&executed] { executed.fetch_add(1); });
+
+		graph.precede(root, node);
+		graph.precede(node, join);
+	}
+
+	assert(graph.compile());
+
+	for (size_t launch = 0; launch < LAUNCHES; ++launch)
+	{
+		graph.launch();
+		graph.wait();
+
+		assert(graph.done());
+		assert(executed.load() == (launch + 1) * (WIDTH + 1));
+	}
+
+	assert(joined == LAUNCHES * (LAUNCHES + 1) / 2 * (WIDTH + 1));
+}
+
+void test_Graph()
+{
+	test_Graph_diamond();
+	test_Graph_roots();
+	test_Graph_fan_out();
+	test_Graph_cycle();
+	test_Graph_threads();
+}
\ No newline at end of file
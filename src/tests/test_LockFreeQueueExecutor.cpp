@@ -0,0 +1,181 @@
+#include "test.hpp"
+#include <adl/dispatcher.h>
+#include <adl/executors/queue_executor.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	enum class LockFreeQueueChannelType : int
+	{
+		L1 = 1,
+		L2 = 2,
+		L3 = 3,
+		L4 = 4,
+		L5 = 5,
+		L6 = 6,
+	};
+
+	template<LockFreeQueueChannelType type>
+	using LockFreeQueueChannel = adl::Channel<LockFreeQueueChannelType, type, adl::LockFreeQueueExecutor>;
+
+	using Channel_L1 = LockFreeQueueChannel<LockFreeQueueChannelType::L1>;
+	using Channel_L2 = LockFreeQueueChannel<LockFreeQueueChannelType::L2>;
+	using Channel_L3 = LockFreeQueueChannel<LockFreeQueueChannelType::L3>;
+	using Channel_L4 = LockFreeQueueChannel<LockFreeQueueChannelType::L4>;
+	using Channel_L5 = LockFreeQueueChannel<LockFreeQueueChannelType::L5>;
+	using Channel_L6 = LockFreeQueueChannel<LockFreeQueueChannelType::L6>;
+}
+
+void test_LockFreeQueueExecutor_post()
+{
+	constexpr size_t ID = __LINE__;
+	constexpr size_t VALUE = __LINE__;
+
+	// Set new initial value
+	reset_value<ID>();
+	// Post function to channel
+	adl::post<Channel_L1>(&set_value<ID, VALUE>);
+	// Still 0, value should be updated after dispatch
+	assert(get_value<ID>() == 0);
+	// Dispatch channel
+	adl::dispatch<Channel_L1>();
+	// Value should be updated
+	assert(get_value<ID>() == VALUE);
+}
+
+void test_LockFreeQueueExecutor_post_bulk()
+{
+	constexpr size_t ID = __LINE__;
+	constexpr size_t ID2 = __LINE__;
+	constexpr size_t ID3 = __LINE__;
+	constexpr size_t VALUE = __LINE__;
+
+	reset_values<ID, ID2, ID3>();
+	// Post functions to channel
+	adl::post_bulk<Channel_L2>(&set_value<ID, VALUE>, &set_value<ID2, VALUE>, &set_value<ID3, VALUE>);
+	// Values should be updated after dispatch
+	assert(get_value<ID>() == 0);
+	assert(get_value<ID2>() == 0);
+	assert(get_value<ID3>() == 0);
+	// Dispatch channel
+	adl::dispatch<Channel_L2>();
+	// Check for updated values
+	assert(get_value<ID>() == VALUE);
+	assert(get_value<ID2>() == VALUE);
+	assert(get_value<ID3>() == VALUE);
+}
+
+void test_LockFreeQueueExecutor_post_future()
+{
+	constexpr size_t ID = __LINE__;
+	constexpr size_t VALUE = __LINE__;
+
+	// Set new initial value
+	set_value<ID, VALUE>();
+	// Post function to channel and get a future
+	auto future = adl::post_future<Channel_L3>(&get_value<ID>);
+	// Future should have a shared state
+	assert(future.valid());
+	// Dispatch channel
+	adl::dispatch<Channel_L3>();
+	// Value should be available
+	assert(future.get() == VALUE);
+}
+
+void test_LockFreeQueueExecutor_post_future_bulk()
+{
+	constexpr size_t ID = __LINE__;
+	constexpr size_t ID2 = __LINE__;
+	constexpr size_t ID3 = __LINE__;
+	constexpr size_t VALUE = __LINE__;
+
+	set_value<ID, VALUE>();
+	set_value<ID2, VALUE>();
+	set_value<ID3, VALUE>();
+	// Post functions to channel and get a futures
+	auto futures = adl::post_future_bulk<Channel_L4>(&get_value<ID>, &get_value<ID2>, &get_value<ID3>);
+	// Futures should have a shared state
+	assert(std::get<0>(futures).valid());
+	assert(std::get<1>(futures).valid());
+	assert(std::get<2>(futures).valid());
+	// Dispatch channel
+	adl::dispatch<Channel_L4>();
+	// Check for updated values
+	assert(std::get<0>(futures).get() == VALUE);
+	assert(std::get<1>(futures).get() == VALUE);
+	assert(std::get<2>(futures).get() == VALUE);
+}
+
+void test_LockFreeQueueExecutor_multiple_producers()
+{
+	constexpr size_t PRODUCERS = 4;
+	constexpr size_t TASKS = 10000;
+
+	// Each producer checks that its tasks are dispatched in the order they were posted
+	size_t counters[PRODUCERS] = {};
+	bool ordered = true;
+
+	std::vector<std::thread> producers;
+
+	for (size_t producer = 0; producer < PRODUCERS; ++producer)
+	{
+		producers.emplace_back([&, producer]
+		{
+			for (size_t i = 0; i < TASKS; i += 2)
+			{
+				adl::post_bulk<Channel_L5>([&, producer, i] { ordered &= counters[producer]++ == i; }
+										  ,[&, producer, i] { ordered &= counters[producer]++ == i + 1; });
+			}
+		});
+	}
+
+	// Dispatch channel while producers are posting tasks
+	size_t dispatched = 0;
+	while (dispatched != PRODUCERS * TASKS)
+	{
+		adl::dispatch<Channel_L5>();
+
+		dispatched = 0;
+		for (size_t counter : counters)
+		{
+			dispatched += counter;
+		}
+	}
+
+	for (auto&& producer : producers)
+	{
+		producer.join();
+	}
+
+	assert(ordered);
+}
+
+void test_LockFreeQueueExecutor_dispatch_n()
+{
+	constexpr size_t ID = __LINE__;
+	constexpr size_t ADD = __LINE__;
+
+	reset_value<ID>();
+
+	adl::post_bulk<Channel_L6>([] { set_a<ID>(add<ADD>(get_value<ID>())); }
+							  ,[] { set_a<ID>(get_value<ID>() * 2); }
+							  ,[] { set_a<ID>(add<ADD>(get_value<ID>())); });
+
+	// Remaining tasks are counted and dispatched in order on the next call
+	assert(adl::dispatch_n<Channel_L6>(1) == 2);
+	assert(get_value<ID>() == ADD);
+
+	assert(adl::dispatch_n<Channel_L6>(2) == 0);
+	assert(get_value<ID>() == ADD * 3);
+}
+
+void test_LockFreeQueueExecutor()
+{
+	test_LockFreeQueueExecutor_post();
+	test_LockFreeQueueExecutor_post_bulk();
+	test_LockFreeQueueExecutor_post_future();
+	test_LockFreeQueueExecutor_post_future_bulk();
+	test_LockFreeQueueExecutor_multiple_producers();
+	test_LockFreeQueueExecutor_dispatch_n();
+}
\ No newline at end of file
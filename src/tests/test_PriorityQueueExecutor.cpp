@@ -0,0 +1,150 @@
+#include "test.hpp"
+#include <adl/dispatcher.h>
+#include <adl/task.h>
+#include <adl/executors/priority_queue_executor.h>
+#include <adl/executors/queue_executor.h>
+#include <vector>
+
+namespace
+{
+	enum class PriorityChannelType : int
+	{
+		P1 = 1,
+		P2 = 2,
+		P3 = 3,
+		P4 = 4,
+		Q1 = 5,
+		P5 = 6,
+		P6 = 7,
+	};
+
+	template<PriorityChannelType type>
+	using PriorityChannel = adl::Channel<PriorityChannelType, type, adl::PriorityQueueExecutor>;
+
+	using Channel_P1 = PriorityChannel<PriorityChannelType::P1>;
+	using Channel_P2 = PriorityChannel<PriorityChannelType::P2>;
+	using Channel_P3 = PriorityChannel<PriorityChannelType::P3>;
+	using Channel_P4 = PriorityChannel<PriorityChannelType::P4>;
+	using Channel_P5 = PriorityChannel<PriorityChannelType::P5>;
+	using Channel_P6 = PriorityChannel<PriorityChannelType::P6>;
+	using Channel_Q1 = adl::Channel<PriorityChannelType, PriorityChannelType::Q1, adl::QueueExecutor>;
+
+	std::vector<int> g_order;
+
+	auto record(int value)
+	{
+		return [value] { g_order.push_back(value); };
+	}
+
+	// The second task defers one task and posts another one on the same level
+	template<typename ChannelType>
+	void post_defer_order()
+	{
+		adl::post<ChannelType>(adl::Priority::High, record(1));
+		adl::post<ChannelType>(adl::Priority::High, [] { g_order.push_back(2); adl::post_defer<ChannelType>(record(4)); adl::post<ChannelType>(record(3)); });
+	}
+}
+
+void test_PriorityQueueExecutor_order()
+{
+	g_order.clear();
+
+	adl::post<Channel_P1>(adl::Priority::Low, record(1));
+	adl::post<Channel_P1>(adl::Priority::Normal, record(2));
+	adl::post<Channel_P1>(adl::Priority::Critical, record(3));
+	adl::post<Channel_P1>(adl::Priority::Low, record(4));
+	adl::post<Channel_P1>(adl::Priority::High, record(5));
+	// Posted without priority, normal priority is used outside of the agents
+	adl::post<Channel_P1>(record(6));
+	adl::post<Channel_P1>(adl::Priority::Critical, record(7));
+
+	adl::dispatch<Channel_P1>();
+
+	// Higher levels first, FIFO within the level
+	assert((g_order == std::vector<int>{ 3, 7, 5, 2, 6, 1, 4 }));
+}
+
+void test_PriorityQueueExecutor_preempt()
+{
+	g_order.clear();
+
+	// Urgent agent posted during the dispatch is executed before the rest of the lower level
+	adl::post<Channel_P2>(adl::Priority::Low, [] { g_order.push_back(1); adl::post<Channel_P2>(adl::Priority::Critical, record(3)); });
+	adl::post<Channel_P2>(adl::Priority::Low, record(4));
+	// Agent posted without priority inherits the priority of the running one
+	adl::post<Channel_P2>(adl::Priority::High, [] { g_order.push_back(0); adl::post<Channel_P2>(record(2)); });
+	adl::post<Channel_P2>(adl::Priority::Normal, record(5));
+
+	assert(adl::dispatch_n<Channel_P2>(2) == 3);
+	assert((g_order == std::vector<int>{ 0, 2 }));
+
+	adl::dispatch<Channel_P2>();
+	assert((g_order == std::vector<int>{ 0, 2, 5, 1, 3, 4 }));
+}
+
+void test_PriorityQueueExecutor_dispatch_order()
+{
+	g_order.clear();
+	post_defer_order<Channel_P5>();
+
+	while (adl::get_executor<Channel_P5>().has_tasks())
+	{
+		adl::dispatch<Channel_P5>();
+	}
+
+	const std::vector<int> dispatched = g_order;
+
+	g_order.clear();
+	post_defer_order<Channel_P6>();
+
+	while (adl::dispatch_n<Channel_P6>(2) != 0);
+
+	// Pending tasks go before deferred ones whatever the budget is
+	assert((dispatched == std::vector<int>{ 1, 2, 3, 4 }));
+	assert(g_order == dispatched);
+}
+
+void test_PriorityQueueExecutor_post_future()
+{
+	auto normal = adl::post_future<Channel_P3>([] { return adl::details::current_priority(); });
+	auto high = adl::post_future<Channel_P3>(adl::Priority::High, [] { return adl::details::current_priority(); });
+
+	// Priority is ignored by the executor without priorities, but the inline executed agent still inherits it
+	auto inlined = adl::post_future<void>(adl::Priority::Low, [] { return adl::details::current_priority(); });
+	assert(inlined.get() == adl::Priority::Low);
+	assert(adl::details::current_priority() == adl::Priority::Normal);
+
+	adl::dispatch<Channel_P3>();
+
+	assert(normal.get() == adl::Priority::Normal);
+	assert(high.get() == adl::Priority::High);
+}
+
+void test_PriorityQueueExecutor_task()
+{
+	g_order.clear();
+
+	// Priority of the chain is kept across the hop through the channel without priorities
+	adl::task<Channel_P4>(record(1))
+		.then<Channel_Q1>(record(2))
+		.then<Channel_P4>([] { assert(adl::details::current_priority() == adl::Priority::High); g_order.push_back(3); })
+		.submit(adl::Priority::High);
+
+	adl::post<Channel_P4>(record(4));
+	adl::dispatch<Channel_P4>();
+	assert((g_order == std::vector<int>{ 1, 4 }));
+
+	adl::post<Channel_P4>(record(5));
+	adl::dispatch<Channel_Q1>();
+	adl::dispatch<Channel_P4>();
+	assert((g_order == std::vector<int>{ 1, 4, 2, 3, 5 }));
+}
+
+void test_PriorityQueueExecutor()
+{
+	test_PriorityQueueExecutor_order();
+	test_PriorityQueueExecutor_preempt();
+	test_PriorityQueueExecutor_dispatch_order();
+	test_PriorityQueueExecutor_post_future();
+	test_PriorityQueueExecutor_task();
+}
\ No newline at end of file
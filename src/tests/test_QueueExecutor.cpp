@@ -1,6 +1,8 @@
 #include "test.hpp"
 #include <adl/dispatcher.h>
 #include <adl/executors/queue_executor.h>
+#include <string>
+#include <thread>
 
 namespace
 {
@@ -10,6 +12,12 @@ namespace
 		Q2 = 2,
 		Q3 = 3,
 		Q4 = 4,
+		Q5 = 5,
+		Q6 = 6,
+		Q7 = 7,
+		Q8 = 8,
+		Q9 = 9,
+		Q10 = 10,
 	};
 
 	template<QueueChannelType type>
@@ -19,6 +27,25 @@ namespace
 	using Channel_Q2 = QueueChannel<QueueChannelType::Q2>;
 	using Channel_Q3 = QueueChannel<QueueChannelType::Q3>;
 	using Channel_Q4 = QueueChannel<QueueChannelType::Q4>;
+	using Channel_Q5 = QueueChannel<QueueChannelType::Q5>;
+	using Channel_Q6 = QueueChannel<QueueChannelType::Q6>;
+	using Channel_Q7 = QueueChannel<QueueChannelType::Q7>;
+	using Channel_Q8 = QueueChannel<QueueChannelType::Q8>;
+	using Channel_Q9 = QueueChannel<QueueChannelType::Q9>;
+	using Channel_Q10 = QueueChannel<QueueChannelType::Q10>;
+
+	// The second task defers one task and posts another one, dispatch order is recorded
+	template<typename ChannelType>
+	void post_defer_order(std::string& order)
+	{
+		adl::post_bulk<ChannelType>([&order] { order += '1'; }
+								   ,[&order]
+									{
+										order += '2';
+										adl::post_defer<ChannelType>([&order] { order += 'D'; });
+										adl::post<ChannelType>([&order] { order += 'B'; });
+									});
+	}
 }
 
 void test_QueueEecutor_post()
@@ -101,10 +128,156 @@ void test_QueueEecutor_post_future_bulk()
 	assert(std::get<2>(futures).get() == VALUE);
 }
 
+void test_QueueEecutor_dispatch_n()
+{
+	constexpr size_t ID = __LINE__;
+	constexpr size_t ADD = __LINE__;
+
+	reset_value<ID>();
+
+	// Every task adds to the value, the second one posts one more task
+	adl::post_bulk<Channel_Q5>([] { set_a<ID>(add<ADD>(get_value<ID>())); }
+							  ,[] { set_a<ID>(add<ADD>(get_value<ID>())); adl::post<Channel_Q5>([] { set_a<ID>(get_value<ID>() * 2); }); }
+							  ,[] { set_a<ID>(add<ADD>(get_value<ID>())); });
+
+	// Dispatch is stopped after two tasks, the rest is left in the queue
+	assert(adl::dispatch_n<Channel_Q5>(2) == 2);
+	assert(get_value<ID>() == ADD * 2);
+
+	// Remaining tasks are dispatched in order
+	assert(adl::dispatch_n<Channel_Q5>(1) == 1);
+	assert(get_value<ID>() == ADD * 3);
+
+	assert(adl::dispatch_n<Channel_Q5>(10) == 0);
+	assert(get_value<ID>() == ADD * 6);
+}
+
+void test_QueueEecutor_dispatch_order()
+{
+	std::string dispatched;
+	std::string dispatchedN;
+
+	post_defer_order<Channel_Q9>(dispatched);
+	post_defer_order<Channel_Q10>(dispatchedN);
+
+	// Pending tasks go before deferred ones whatever the budget is
+	while (adl::get_executor<Channel_Q9>().has_tasks())
+	{
+		adl::dispatch<Channel_Q9>();
+	}
+
+	while (adl::dispatch_n<Channel_Q10>(2) != 0);
+
+	assert(dispatched == "12BD");
+	assert(dispatchedN == dispatched);
+}
+
+void test_QueueEecutor_dispatch_for()
+{
+	constexpr size_t ID = __LINE__;
+	constexpr size_t TASKS = 1000;
+
+	reset_value<ID>();
+
+	for (size_t i = 0; i < TASKS; ++i)
+	{
+		adl::post<Channel_Q6>([] { set_a<ID>(get_value<ID>() + 1); });
+	}
+
+	// No time budget, nothing is dispatched
+	assert(adl::dispatch_for<Channel_Q6>(std::chrono::nanoseconds{ 0 }) == TASKS);
+	assert(get_value<ID>() == 0);
+
+	size_t remaining = TASKS;
+
+	while (remaining != 0)
+	{
+		const size_t next = adl::dispatch_for<Channel_Q6>(std::chrono::microseconds{ 10 });
+
+		// Dispatched and remaining tasks always add up
+		assert(get_value<ID>() == TASKS - next);
+
+		remaining = next;
+	}
+
+	assert(get_value<ID>() == TASKS);
+}
+
+void test_QueueEecutor_run_until()
+{
+	constexpr size_t ID = __LINE__;
+	constexpr size_t TASKS = 1000;
+
+	reset_value<ID>();
+
+	adl::stop_source stop;
+	std::thread thread{ [token = stop.get_token()] { adl::run_until<Channel_Q7>(token); } };
+
+	// Consumer is parked between the tasks and woken by every post
+	for (size_t i = 0; i < TASKS; ++i)
+	{
+		adl::post_future<Channel_Q7>([] { set_a<ID>(get_value<ID>() + 1); }).get();
+	}
+
+	assert(get_value<ID>() == TASKS);
+
+	// Parked consumer is woken by the stop request
+	stop.request_stop();
+	thread.join();
+
+	// Tasks are not dispatched after the stop
+	adl::post<Channel_Q7>([] { set_a<ID>(0); });
+	adl::run_until<Channel_Q7>(stop.get_token());
+	assert(get_value<ID>() == TASKS);
+
+	adl::dispatch<Channel_Q7>();
+	assert(get_value<ID>() == 0);
+}
+
+void test_QueueEecutor_run()
+{
+	constexpr size_t SPINS = 1000;
+	constexpr size_t DEFERS = 3;
+
+	struct DeferredTask
+	{
+		void operator()() const
+		{
+			if (count->fetch_add(1) + 1 < DEFERS)
+			{
+				adl::post_defer<Channel_Q8>(*this);
+			}
+		}
+
+		std::atomic_size_t* count;
+	};
+
+	std::atomic_size_t count{ 0 };
+	std::thread thread{ [] { adl::get_executor<Channel_Q8>().run(SPINS); } };
+
+	// Deferred tasks are dispatched again without a new post
+	adl::post<Channel_Q8>(DeferredTask{ &count });
+
+	while (count.load() < DEFERS)
+	{
+		std::this_thread::yield();
+	}
+
+	adl::stop<Channel_Q8>();
+	thread.join();
+
+	assert(count.load() == DEFERS);
+}
+
 void test_QueueEecutor()
 {
 	test_QueueEecutor_post();
 	test_QueueEecutor_post_bulk();
 	test_QueueEecutor_post_future();
 	test_QueueEecutor_post_future_bulk();
+	test_QueueEecutor_dispatch_n();
+	test_QueueEecutor_dispatch_order();
+	test_QueueEecutor_dispatch_for();
+	test_QueueEecutor_run_until();
+	test_QueueEecutor_run();
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "test.hpp"
 #include <adl/dispatcher.h>
 #include <adl/executors/strand_executor.h>
+#include <string>
+#include <thread>
 
 namespace
 {
@@ -10,6 +12,8 @@ namespace
 		S2 = 2,
 		S3 = 3,
 		S4 = 4,
+		S5 = 5,
+		S6 = 6,
 	};
 
 	template<StrandChannelType type>
@@ -19,6 +23,8 @@ namespace
 	using Channel_S2 = StrandChannel<StrandChannelType::S2>;
 	using Channel_S3 = StrandChannel<StrandChannelType::S3>;
 	using Channel_S4 = StrandChannel<StrandChannelType::S4>;
+	using Channel_S5 = StrandChannel<StrandChannelType::S5>;
+	using Channel_S6 = StrandChannel<StrandChannelType::S6>;
 }
 
 void test_StrandEecutor_post()
@@ -101,10 +107,50 @@ void test_StrandEecutor_post_future_bulk()
 	assert(std::get<2>(futures).get() == VALUE);
 }
 
+void test_StrandEecutor_run_until()
+{
+	constexpr size_t ID = __LINE__;
+	constexpr size_t VALUE = __LINE__;
+
+	reset_value<ID>();
+
+	adl::stop_source stop;
+	std::thread thread{ [token = stop.get_token()] { adl::run_until<Channel_S5>(token); } };
+
+	// Parked consumer is woken by the posted task
+	auto future = adl::post_future<Channel_S5>([] { set_value<ID, VALUE>(); return get_value<ID>(); });
+	assert(future.get() == VALUE);
+
+	stop.request_stop();
+	thread.join();
+}
+
+void test_StrandEecutor_reentrant_dispatch()
+{
+	std::string order;
+
+	// Task dispatches the strand again, the batch which is executed isn't touched by the nested dispatch
+	adl::post_bulk<Channel_S6>([&order]
+	{
+		order += '1';
+		adl::post<Channel_S6>([&order] { order += '3'; });
+		adl::dispatch<Channel_S6>();
+	},
+		[&order] { order += '2'; });
+
+	adl::dispatch<Channel_S6>();
+	assert(order == "132");
+
+	adl::dispatch<Channel_S6>();
+	assert(order == "132");
+}
+
 void test_StrandEecutor()
 {
 	test_StrandEecutor_post();
 	test_StrandEecutor_post_bulk();
 	test_StrandEecutor_post_future();
 	test_StrandEecutor_post_future_bulk();
+	test_StrandEecutor_run_until();
+	test_StrandEecutor_reentrant_dispatch();
 }
\ No newline at end of file
@@ -82,10 +82,10 @@ void test_Task_submit()
 
 #define TEST_POST(T1, T2, T3, T4) \
 	reset_values<PID, PID2, PID3, PID4>(); \
-	adl::task(set_ ## T1 ## <PID, PVALUE>) \
-		.post(set_ ## T2 ## <PID2, PVALUE>) \
-		.post(set_ ## T3 ## <PID3, PVALUE>) \
-		.post(set_ ## T4 ## <PID4, PVALUE>) \
+	adl::task(set_ ## T1 <PID, PVALUE>) \
+		.post(set_ ## T2 <PID2, PVALUE>) \
+		.post(set_ ## T3 <PID3, PVALUE>) \
+		.post(set_ ## T4 <PID4, PVALUE>) \
 		.submit(); \
 	test_values()
 
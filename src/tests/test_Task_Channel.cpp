@@ -1,10 +1,12 @@
 #include "test.hpp"
 #include <adl/task.h>
+#include <adl/channel_thread.h>
 #include <adl/executors/async_executor.h>
 #include <adl/executors/queue_executor.h>
 #include <thread>
 #include <condition_variable>
 #include <mutex>
+#include <stdexcept>
 
 namespace
 {
@@ -25,44 +27,13 @@ namespace
 	using Channel_Q3 = adl::Channel<ChannelType, ChannelType::Q3, adl::QueueExecutor>;
 	using Channel_Q4 = adl::Channel<ChannelType, ChannelType::Q4, adl::QueueExecutor>;
 
-	// Require manual dispatch to clean outdated futures
+	// Dispatched by executor threads
 	using Channel_A = adl::Channel<ChannelType, ChannelType::A, adl::AsyncExecutor>;
 
 	// Dispatched in separate threads
 	using Channel_T1 = adl::Channel<ChannelType, ChannelType::T1, adl::QueueExecutor>; 
 	using Channel_T2 = adl::Channel<ChannelType, ChannelType::T2, adl::QueueExecutor>;	
 
-	template<typename ChannelType>
-	class jthread
-	{
-	public:
-
-		jthread()
-			: m_done{ false }
-			, m_thread{ &dispatch_channel, std::ref(m_done) }
-		{}
-
-		~jthread()
-		{
-			m_done = true;
-			m_thread.join();
-		}
-
-	private:
-
-		std::atomic_bool m_done;
-		std::thread m_thread;
-
-		static void dispatch_channel(std::atomic_bool& done)
-		{
-			while (!done)
-			{
-				adl::dispatch<ChannelType>();
-				std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
-			}
-		}
-	};	
-
 	constexpr size_t PID1 = __LINE__;
 	constexpr size_t PID2 = __LINE__;
 	constexpr size_t PID3 = __LINE__;
@@ -93,6 +64,21 @@ namespace
 		cv.notify_one();
 		return result;
 	}
+
+	// Post itself to the channel until the count is reached
+	struct Hop
+	{
+		void operator()() const
+		{
+			if (++(*count) < limit)
+			{
+				adl::post_or_invoke<Channel_Q1>(*this);
+			}
+		}
+
+		size_t* count;
+		size_t limit;
+	};
 }
 
 void test_Task_Post_Async()
@@ -131,7 +117,7 @@ void test_Task_Post_Async()
 	{
 		wait_for_value<PID3, GEN3>(cv_a);
 		assert(get_value<PID3>() == GEN3);
-		// Dispatch to release outdated futures in async_executor
+		// Dispatch is not needed for async_executor, but still supported
 		adl::dispatch<Channel_A>();
 	}
 
@@ -691,10 +677,109 @@ void test_Task_Mixed()
 	}
 }
 
+void test_Task_Hop()
+{
+	{
+		reset_values<PID1, PID2>();
+
+		adl::task<Channel_Q1>(&generate<GEN1>)
+			.then<Channel_Q1>(&add<ADD1>)
+			.then<Channel_Q1>(&add<ADD2>)
+			.then<Channel_Q1>(&set_a<PID1>)
+			.submit();
+
+		// Same-channel continuations are invoked inline by the dispatched agent
+		assert(adl::dispatch_n<Channel_Q1>(1) == 0);
+		assert(get_value<PID1>() == GEN1 + ADD1 + ADD2);
+
+		adl::task<Channel_Q1>(&generate<GEN2>)
+			.then<Channel_Q1>(&add<ADD1>)
+			.then_post<Channel_Q1>(&add<ADD2>)
+			.then<Channel_Q1>(&set_a<PID2>)
+			.submit();
+
+		// Opt-out continuation is queued
+		assert(adl::dispatch_n<Channel_Q1>(1) == 1);
+		assert(get_value<PID2>() == 0);
+
+		assert(adl::dispatch_n<Channel_Q1>(1) == 0);
+		assert(get_value<PID2>() == GEN2 + ADD1 + ADD2);
+	}
+
+	{
+		reset_values<PID1, PID2>();
+
+		// Nested task of the same channel is invoked inline, other channels are still posted
+		adl::task<Channel_Q1>(&generate<GEN1>)
+			.then<Channel_Q1>(adl::task<Channel_Q1>(&set_value<PID1, GEN1>))
+			.submit();
+
+		adl::task<Channel_Q1>(&generate<GEN2>)
+			.then<Channel_Q1>(adl::task<Channel_Q2>(&set_value<PID2, GEN2>))
+			.submit();
+
+		assert(adl::dispatch_n<Channel_Q1>(1) == 1);
+		assert(get_value<PID1>() == GEN1);
+
+		assert(adl::dispatch_n<Channel_Q1>(1) == 0);
+		assert(get_value<PID2>() == 0);
+
+		adl::dispatch<Channel_Q2>();
+		assert(get_value<PID2>() == GEN2);
+	}
+
+	{
+		// Depth of the inline invocations is limited, the deeper agent is posted
+		size_t count = 0;
+		adl::post<Channel_Q1>(Hop{ &count, 2 * ADL_MAX_INLINE_HOPS });
+
+		assert(adl::dispatch_n<Channel_Q1>(1) == 1);
+		assert(count == ADL_MAX_INLINE_HOPS + 1);
+
+		adl::dispatch<Channel_Q1>();
+		assert(count == 2 * ADL_MAX_INLINE_HOPS);
+
+		// Agents are posted if the channel is not dispatched by the current thread
+		count = 0;
+		Hop{ &count, 2 }();
+		assert(count == 1);
+
+		adl::dispatch<Channel_Q1>();
+		assert(count == 2);
+	}
+
+	{
+		// Depth is restored when the inline agent throws
+		adl::post<Channel_Q1>([] { adl::post_or_invoke<Channel_Q1>([] { throw std::runtime_error{ "inline" }; }); });
+
+		bool thrown = false;
+
+		try
+		{
+			adl::dispatch<Channel_Q1>();
+		}
+		catch (const std::runtime_error&)
+		{
+			thrown = true;
+		}
+
+		assert(thrown);
+
+		size_t count = 0;
+		adl::post<Channel_Q1>(Hop{ &count, 2 * ADL_MAX_INLINE_HOPS });
+
+		assert(adl::dispatch_n<Channel_Q1>(1) == 1);
+		assert(count == ADL_MAX_INLINE_HOPS + 1);
+
+		adl::dispatch<Channel_Q1>();
+		assert(count == 2 * ADL_MAX_INLINE_HOPS);
+	}
+}
+
 void test_Task_Channel()
 {
-	jthread<Channel_T1> t1;
-	jthread<Channel_T2> t2;
+	adl::ChannelThread<Channel_T1> t1;
+	adl::ChannelThread<Channel_T2> t2;
 			
 	test_Task_Then();
 	test_Task_Post();
@@ -703,4 +788,5 @@ void test_Task_Channel()
 	test_Task_Then_Async();	
 	test_Task_Nested();
 	test_Task_Mixed();	
+	test_Task_Hop();
 }
\ No newline at end of file
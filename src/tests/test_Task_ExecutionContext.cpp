@@ -1,6 +1,8 @@
 #include "test.hpp"
 #include <adl/task.h>
 #include <adl/executors/queue_executor.h>
+#include <chrono>
+#include <thread>
 
 namespace
 {
@@ -48,8 +50,8 @@ namespace
 	template<size_t ID>
 	size_t set_and_return(size_t value)
 	{
-		ValueHolder::value = value;
-		return ValueHolder::value;
+		ValueHolder<ID>::value = value;
+		return ValueHolder<ID>::value;
 	}
 
 	template<size_t value>
@@ -85,6 +87,23 @@ namespace
 
 		bool defer = true;
 	};
+
+	// Deferred once for the duration, counts invocations
+	template<size_t addValue>
+	struct AddDeferForOnce
+	{
+		size_t operator()(adl::ExecutionContext& context, size_t prevValue)
+		{
+			if (++(*invocations) == 1)
+			{
+				context.defer_for(std::chrono::milliseconds{ 20 });
+			}
+
+			return prevValue + addValue;
+		}
+
+		size_t* invocations;
+	};
 }
 
 void test_Task_ExecutionCancel()
@@ -278,8 +297,110 @@ void test_Task_ExecutionDefer()
 	}
 }
 
+void test_Task_ExecutionDeferParked()
+{
+	constexpr size_t ID = __LINE__;
+	constexpr size_t GEN = __LINE__;
+	constexpr size_t ADD = __LINE__;
+
+	{
+		reset_value<ID>();
+
+		size_t invocations = 0;
+		const auto start = std::chrono::steady_clock::now();
+
+		adl::task<Channel_Q3>(&generate<GEN>)
+			.then<Channel_Q4>(AddDeferForOnce<ADD>{ &invocations })
+			.then(&set_a<ID>)
+			.submit();
+
+		adl::dispatch<Channel_Q3>();
+		adl::dispatch<Channel_Q4>();
+
+		// Deferred task is parked in the timer executor, it isn't posted again until the deadline
+		assert(invocations == 1);
+		assert(adl::dispatch_n<Channel_Q4>(0) == 0);
+
+		while (get_value<ID>() == 0)
+		{
+			adl::dispatch<Channel_Q4>();
+			std::this_thread::yield();
+		}
+
+		assert(invocations == 2);
+		assert(get_value<ID>() == GEN + ADD);
+		assert(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds{ 20 });
+	}
+
+	{
+		reset_value<ID>();
+
+		adl::event event;
+		size_t invocations = 0;
+
+		adl::task<Channel_Q3>(&generate<GEN>)
+			.then<Channel_Q4>([&event, &invocations](adl::ExecutionContext& context, size_t value)
+			{
+				if (++invocations == 1)
+				{
+					context.defer_until(event);
+				}
+
+				return value + ADD;
+			})
+			.then(&set_a<ID>)
+			.submit();
+
+		adl::dispatch<Channel_Q3>();
+		adl::dispatch<Channel_Q4>();
+
+		// Deferred task is parked in the event with the result of the previous agent
+		assert(invocations == 1);
+		assert(event.size() == 1);
+		assert(adl::dispatch_n<Channel_Q4>(0) == 0);
+
+		event.set();
+		assert(event.size() == 0);
+
+		adl::dispatch<Channel_Q4>();
+
+		assert(invocations == 2);
+		assert(get_value<ID>() == GEN + ADD);
+	}
+
+	{
+		reset_value<ID>();
+
+		// Task deferred until the set event is posted again immediately
+		adl::event event{ true };
+		size_t invocations = 0;
+
+		adl::task<Channel_Q3>(&generate<GEN>)
+			.then<Channel_Q3>([&event, &invocations](adl::ExecutionContext& context, size_t value)
+			{
+				if (++invocations == 1)
+				{
+					context.defer_until(event);
+				}
+
+				return value;
+			})
+			.then(&set_a<ID>)
+			.submit();
+
+		while (get_value<ID>() == 0)
+		{
+			adl::dispatch<Channel_Q3>();
+		}
+
+		assert(invocations == 2);
+		assert(get_value<ID>() == GEN);
+	}
+}
+
 void test_Task_ExecutionContext()
 {
 	test_Task_ExecutionCancel();
 	test_Task_ExecutionDefer();
+	test_Task_ExecutionDeferParked();
 }
\ No newline at end of file
@@ -0,0 +1,196 @@
+#include "test.hpp"
+#include <adl/task.h>
+#include <adl/executors/thread_pool_executor.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+
+namespace
+{
+	enum class ThreadPoolChannelType : int
+	{
+		P1 = 1,
+		P2 = 2,
+	};
+
+	template<ThreadPoolChannelType type>
+	using ThreadPoolChannel = adl::Channel<ThreadPoolChannelType, type, adl::ThreadPoolExecutor>;
+
+	using Channel_P1 = ThreadPoolChannel<ThreadPoolChannelType::P1>;
+	using Channel_P2 = ThreadPoolChannel<ThreadPoolChannelType::P2>;
+}
+
+void test_ThreadPoolExecutor_post()
+{
+	constexpr size_t VALUE = __LINE__;
+
+	std::promise<size_t> promise;
+	auto future = promise.get_future();
+
+	// Post function to channel
+	adl::post<Channel_P1>([&] { promise.set_value(VALUE); });
+
+	// Value should be set by one of the workers
+	assert(future.get() == VALUE);
+}
+
+void test_ThreadPoolExecutor_post_bulk()
+{
+	constexpr size_t VALUE = __LINE__;
+
+	std::promise<size_t> promises[3];
+
+	// Post functions to channel
+	adl::post_bulk<Channel_P1>([&] { promises[0].set_value(VALUE); }
+							  ,[&] { promises[1].set_value(VALUE); }
+							  ,[&] { promises[2].set_value(VALUE); });
+
+	for (auto&& promise : promises)
+	{
+		assert(promise.get_future().get() == VALUE);
+	}
+}
+
+void test_ThreadPoolExecutor_post_future()
+{
+	constexpr size_t ID = __LINE__;
+	constexpr size_t VALUE = __LINE__;
+
+	// Set new initial value
+	set_value<ID, VALUE>();
+	// Post function to channel and get a future
+	auto future = adl::post_future<Channel_P1>(&get_value<ID>);
+	// Future should have a shared state
+	assert(future.valid());
+	// Value should be available
+	assert(future.get() == VALUE);
+}
+
+void test_ThreadPoolExecutor_post_future_bulk()
+{
+	constexpr size_t ID = __LINE__;
+	constexpr size_t ID2 = __LINE__;
+	constexpr size_t ID3 = __LINE__;
+	constexpr size_t VALUE = __LINE__;
+
+	set_value<ID, VALUE>();
+	set_value<ID2, VALUE>();
+	set_value<ID3, VALUE>();
+	// Post functions to channel and get a futures
+	auto futures = adl::post_future_bulk<Channel_P1>(&get_value<ID>, &get_value<ID2>, &get_value<ID3>);
+	// Check for updated values
+	assert(std::get<0>(futures).get() == VALUE);
+	assert(std::get<1>(futures).get() == VALUE);
+	assert(std::get<2>(futures).get() == VALUE);
+}
+
+void test_ThreadPoolExecutor_nested_post()
+{
+	constexpr size_t TASKS = 1000;
+	constexpr size_t NESTED_TASKS = 10;
+
+	std::atomic_size_t counter{ 0 };
+	std::promise<void> done;
+
+	// Tasks posted from workers go to the local deques and can be stolen by other workers
+	for (size_t i = 0; i < TASKS; ++i)
+	{
+		adl::post<Channel_P2>([&]
+		{
+			for (size_t j = 0; j < NESTED_TASKS; ++j)
+			{
+				adl::post<Channel_P2>([&]
+				{
+					if (++counter == TASKS * NESTED_TASKS)
+					{
+						done.set_value();
+					}
+				});
+			}
+		});
+	}
+
+	done.get_future().wait();
+
+	assert(counter == TASKS * NESTED_TASKS);
+}
+
+void test_ThreadPoolExecutor_task()
+{
+	constexpr size_t GEN = __LINE__;
+	constexpr size_t ADD = __LINE__;
+
+	std::promise<size_t> promise;
+	auto future = promise.get_future();
+
+	adl::task<Channel_P1>(&generate<GEN>)
+		.then<Channel_P2>(&add<ADD>)
+		.then<Channel_P1>(&add<ADD>)
+		.then<Channel_P2>([&promise](size_t value) { promise.set_value(value); })
+		.submit();
+
+	assert(future.get() == GEN + ADD + ADD);
+}
+
+void test_ThreadPoolExecutor_wake_workers()
+{
+	constexpr size_t WORKERS = 4;
+
+	std::atomic_size_t running{ 0 };
+	std::atomic_size_t overlapped{ 0 };
+	std::atomic_size_t finished{ 0 };
+
+	// Every task waits until all of them run at once, so they are spread over the workers instead of one worker running them in turn
+	const auto task = [&running, &overlapped, &finished]
+	{
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{ 5 };
+		running.fetch_add(1);
+
+		while (running.load() < WORKERS && std::chrono::steady_clock::now() < deadline)
+		{
+			std::this_thread::yield();
+		}
+
+		if (running.load() == WORKERS)
+		{
+			overlapped.fetch_add(1);
+		}
+
+		finished.fetch_add(1);
+	};
+
+	for (size_t round = 0; round < 3; ++round)
+	{
+		running.store(0);
+		overlapped.store(0);
+		finished.store(0);
+
+		{
+			adl::ThreadPoolExecutor executor{ WORKERS };
+
+			// Workers are idle before the post
+			std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+			executor.bulk_execute(task, task, task, task);
+
+			// Destructor of the executor wakes up all workers, so it waits for the tasks
+			while (finished.load() < WORKERS)
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		assert(overlapped.load() == WORKERS);
+	}
+}
+
+void test_ThreadPoolExecutor()
+{
+	test_ThreadPoolExecutor_post();
+	test_ThreadPoolExecutor_post_bulk();
+	test_ThreadPoolExecutor_post_future();
+	test_ThreadPoolExecutor_post_future_bulk();
+	test_ThreadPoolExecutor_nested_post();
+	test_ThreadPoolExecutor_task();
+	test_ThreadPoolExecutor_wake_workers();
+}
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "test.hpp"
+#include <adl/timers.h>
+#include <adl/executors/queue_executor.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	enum class TimerChannelType : int
+	{
+		T1 = 1,
+		T2 = 2,
+		T3 = 3,
+		T4 = 4,
+	};
+
+	using Channel_T1 = adl::Channel<TimerChannelType, TimerChannelType::T1, adl::LockFreeQueueExecutor>;
+	using Channel_T2 = adl::Channel<TimerChannelType, TimerChannelType::T2, adl::LockFreeQueueExecutor>;
+	using Channel_T3 = adl::Channel<TimerChannelType, TimerChannelType::T3, adl::LockFreeQueueExecutor>;
+	using Channel_T4 = adl::Channel<TimerChannelType, TimerChannelType::T4, adl::LockFreeQueueExecutor>;
+
+	using wheel_t = adl::details::TimingWheel<size_t>;
+	using timer_clock = std::chrono::steady_clock;
+
+	// Dispatch the channel until the predicate is satisfied
+	template<typename ChannelType, typename Predicate>
+	void dispatch_until(Predicate&& predicate)
+	{
+		while (!predicate())
+		{
+			adl::dispatch<ChannelType>();
+			std::this_thread::yield();
+		}
+	}
+}
+
+void test_Timers_wheel()
+{
+	wheel_t wheel;
+	std::vector<wheel_t::Node*> expired;
+
+	// Timers of every level expire exactly on their tick after cascading
+	const uint64_t deltas[] = { 1, 2, 255, 256, 257, 511, 65535, 65536, 65537, 100000, (uint64_t{ 1 } << 24) - 1, (uint64_t{ 1 } << 24) + 5 };
+
+	for (uint64_t delta : deltas)
+	{
+		const uint64_t expiry = wheel.now() + delta;
+		wheel.insert(expiry, static_cast<size_t>(delta));
+
+		wheel.advance(expiry - 1, expired);
+		assert(expired.empty());
+
+		wheel.advance(expiry, expired);
+		assert(expired.size() == 1);
+		assert(expired[0]->payload == delta);
+		assert(wheel.empty());
+
+		wheel.release(expired[0]);
+		expired.clear();
+	}
+
+	// Canceled timer doesn't expire, stale handle can't cancel reused node
+	auto handle = wheel.insert(wheel.now() + 300, 1);
+	assert(wheel.cancel(handle));
+	assert(!wheel.cancel(handle));
+
+	auto other = wheel.insert(wheel.now() + 10, 2);
+	assert(!wheel.cancel(handle));
+
+	// Timers with the same expiry expire in insertion order, expired timers expire on the next tick
+	wheel.insert(wheel.now() + 10, 3);
+	wheel.insert(0, 4);
+	wheel.advance(wheel.now() + 1, expired);
+	assert(expired.size() == 1 && expired[0]->payload == 4);
+
+	wheel.advance(wheel.now() + 1000, expired);
+	assert(expired.size() == 3 && expired[1]->payload == 2 && expired[2]->payload == 3);
+	assert(!wheel.cancel(other));
+}
+
+void test_Timers_post_after()
+{
+	std::vector<int> order;
+	const timer_clock::time_point start = timer_clock::now();
+
+	adl::post_after<Channel_T1>(std::chrono::milliseconds{ 30 }, [&order, start] { assert(timer_clock::now() - start >= std::chrono::milliseconds{ 30 }); order.push_back(3); });
+	adl::post_after<Channel_T1>(std::chrono::milliseconds{ 10 }, [&order, start] { assert(timer_clock::now() - start >= std::chrono::milliseconds{ 10 }); order.push_back(1); });
+	adl::post_at<Channel_T1>(std::chrono::system_clock::now() + std::chrono::milliseconds{ 20 }, [&order] { order.push_back(2); });
+
+	// Canceled timer is never posted
+	auto canceled = adl::post_after<Channel_T1>(std::chrono::milliseconds{ 15 }, [&order] { order.push_back(0); });
+	assert(canceled.cancel());
+	assert(!canceled.cancel());
+
+	dispatch_until<Channel_T1>([&] { return order.size() == 3; });
+	assert((order == std::vector<int>{ 1, 2, 3 }));
+}
+
+void test_Timers_post_every()
+{
+	constexpr size_t TICKS = 5;
+
+	std::atomic_size_t ticks{ 0 };
+	auto timer = adl::post_every<Channel_T2>(std::chrono::milliseconds{ 2 }, [&ticks] { ticks.fetch_add(1); });
+
+	dispatch_until<Channel_T2>([&] { return ticks.load() >= TICKS; });
+
+	// Periodic timer is pending until canceled
+	assert(timer.cancel());
+	assert(!timer.cancel());
+
+	std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+	adl::dispatch<Channel_T2>();
+
+	const size_t canceledTicks = ticks.load();
+	std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+	adl::dispatch<Channel_T2>();
+	assert(ticks.load() == canceledTicks);
+}
+
+void test_Timers_batch()
+{
+	constexpr size_t TIMERS = 1000;
+
+	size_t executed = 0;
+	const timer_clock::time_point deadline = timer_clock::now() + std::chrono::milliseconds{ 5 };
+
+	for (size_t i = 0; i < TIMERS; ++i)
+	{
+		adl::post_at<Channel_T3>(deadline, [&executed] { ++executed; });
+	}
+
+	// Timers expired on the same tick are posted to the channel as a single agent
+	while (adl::get_executor<Channel_T3>().dispatch_n(0) == 0)
+	{
+		std::this_thread::yield();
+	}
+
+	assert(adl::get_executor<Channel_T3>().dispatch_n(0) == 1);
+
+	adl::dispatch<Channel_T3>();
+	assert(executed == TIMERS);
+}
+
+void test_Timers_destroy_executor()
+{
+	std::atomic_size_t executed{ 0 };
+	const size_t pending = adl::get_timer_executor().size();
+
+	{
+		// Executor is destroyed by the scope while its timers are pending
+		adl::ExecutorScope<Channel_T4> scope;
+		adl::post_after<Channel_T4>(std::chrono::milliseconds{ 5 }, [&executed] { executed.fetch_add(1); });
+		adl::post_every<Channel_T4>(std::chrono::milliseconds{ 50 }, [&executed] { executed.fetch_add(1); });
+
+		assert(adl::get_timer_executor().size() == pending + 2);
+	}
+
+	// Timers of the destroyed executor are canceled, so nothing is posted to it
+	assert(adl::get_timer_executor().size() == pending);
+	std::this_thread::sleep_for(std::chrono::milliseconds{ 20 });
+
+	adl::construct_executors<Channel_T4>();
+	assert(!adl::get_executor<Channel_T4>().has_tasks());
+	assert(executed.load() == 0);
+}
+
+void test_Timers()
+{
+	test_Timers_wheel();
+	test_Timers_post_after();
+	test_Timers_post_every();
+	test_Timers_batch();
+	test_Timers_destroy_executor();
+}
\ No newline at end of file
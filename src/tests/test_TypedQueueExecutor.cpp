@@ -0,0 +1,215 @@
+#include "test.hpp"
+#include <adl/channel_thread.h>
+#include <adl/executors/queue_executor.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+	enum class TypedQueueChannelType : int
+	{
+		Q1 = 1,
+		Q2 = 2,
+		S1 = 3,
+		T1 = 4,
+	};
+
+	struct Append
+	{
+		void operator()() const
+		{
+			order->push_back(value);
+		}
+
+		std::vector<size_t>* order;
+		size_t value;
+	};
+
+	// Holds a shared pointer, so the released tasks can be counted
+	struct Release
+	{
+		void operator()() const
+		{
+			++*executed;
+		}
+
+		std::shared_ptr<size_t> executed;
+	};
+
+	struct Increment
+	{
+		void operator()() const
+		{
+			counter->fetch_add(1, std::memory_order_relaxed);
+		}
+
+		std::atomic_size_t* counter;
+	};
+
+	using Channel_Q1 = adl::Channel<TypedQueueChannelType, TypedQueueChannelType::Q1, adl::TypedQueueExecutor<Append>>;
+	using Channel_Q2 = adl::Channel<TypedQueueChannelType, TypedQueueChannelType::Q2, adl::TypedQueueExecutor<Release>>;
+	using Channel_S1 = adl::Channel<TypedQueueChannelType, TypedQueueChannelType::S1, adl::TypedQueueExecutor<Append>, adl::Concurrency::SingleThread>;
+
+	// Dispatched in a separate thread
+	using Channel_T1 = adl::Channel<TypedQueueChannelType, TypedQueueChannelType::T1, adl::TypedQueueExecutor<Increment>>;
+
+	// Single-thread channel keeps the ring without the lock
+	static_assert(std::is_same_v<Channel_S1::executor_t, adl::BasicQueueExecutor<adl::details::UnsyncTaskQueue<Append, adl::details::RingBuffer<Append>>>>);
+}
+
+void test_TypedQueueExecutor_ring()
+{
+	adl::details::RingBuffer<size_t> ring;
+	size_t pushed = 0;
+	size_t popped = 0;
+
+	// Values wrap around the storage and keep FIFO order when the ring grows
+	for (size_t round = 0; round < 4; ++round)
+	{
+		for (size_t i = 0; i < 12 + round * 10; ++i)
+		{
+			ring.emplace_back(pushed++);
+		}
+
+		for (size_t i = 0; i < 10; ++i)
+		{
+			assert(ring.front() == popped++);
+			ring.pop_front();
+		}
+
+		assert(ring.size() == pushed - popped);
+	}
+
+	adl::details::RingBuffer<size_t> other;
+	other.swap(ring);
+	assert(ring.empty());
+
+	while (!other.empty())
+	{
+		assert(other.front() == popped++);
+		other.pop_front();
+	}
+
+	assert(popped == pushed);
+}
+
+void test_TypedQueueExecutor_post()
+{
+	std::vector<size_t> order;
+	std::vector<size_t> expected;
+
+	adl::post<Channel_Q1>(Append{ &order, 0 });
+	adl::post_bulk<Channel_Q1>(Append{ &order, 1 }, Append{ &order, 2 }, Append{ &order, 3 });
+
+	const Append task{ &order, 4 };
+	adl::post<Channel_Q1>(task);
+
+	adl::dispatch<Channel_Q1>();
+	assert((order == std::vector<size_t>{ 0, 1, 2, 3, 4 }));
+
+	// Remaining tasks are kept in order while more tasks are appended to the batch
+	order.clear();
+
+	for (size_t i = 0; i < 10; ++i)
+	{
+		adl::post<Channel_Q1>(Append{ &order, i });
+		expected.push_back(i);
+	}
+
+	assert(adl::dispatch_n<Channel_Q1>(6) == 4);
+
+	for (size_t i = 10; i < 40; ++i)
+	{
+		adl::post<Channel_Q1>(Append{ &order, i });
+		expected.push_back(i);
+	}
+
+	assert(adl::dispatch_n<Channel_Q1>(1) == 33);
+	adl::dispatch<Channel_Q1>();
+	assert(order == expected);
+
+	// Deferred tasks are executed by the next dispatch
+	order.clear();
+	adl::post_defer<Channel_Q1>(Append{ &order, 1 });
+	adl::post<Channel_Q1>(Append{ &order, 0 });
+	adl::dispatch<Channel_Q1>();
+	assert((order == std::vector<size_t>{ 0 }));
+	adl::dispatch<Channel_Q1>();
+	assert((order == std::vector<size_t>{ 0, 1 }));
+}
+
+void test_TypedQueueExecutor_release()
+{
+	auto executed = std::make_shared<size_t>(0);
+
+	for (size_t i = 0; i < 100; ++i)
+	{
+		adl::post<Channel_Q2>(Release{ executed });
+	}
+
+	assert(executed.use_count() == 101);
+
+	// Executed tasks are destroyed by the dispatch
+	adl::dispatch<Channel_Q2>();
+	assert(*executed == 100);
+	assert(executed.use_count() == 1);
+}
+
+void test_TypedQueueExecutor_single_thread()
+{
+	std::vector<size_t> order;
+
+	adl::post<Channel_S1>(Append{ &order, 0 });
+	adl::post_bulk<Channel_S1>(Append{ &order, 1 }, Append{ &order, 2 });
+	adl::dispatch<Channel_S1>();
+
+	assert((order == std::vector<size_t>{ 0, 1, 2 }));
+}
+
+void test_TypedQueueExecutor_threads()
+{
+	constexpr size_t PRODUCERS = 4;
+	constexpr size_t TASKS = 10000;
+
+	std::atomic_size_t counter{ 0 };
+
+	{
+		adl::ChannelThread<Channel_T1> thread;
+		std::vector<std::thread> producers;
+
+		for (size_t i = 0; i < PRODUCERS; ++i)
+		{
+			producers.emplace_back([&counter]
+			{
+				for (size_t task = 0; task < TASKS; ++task)
+				{
+					adl::post<Channel_T1>(Increment{ &counter });
+				}
+			});
+		}
+
+		for (auto&& producer : producers)
+		{
+			producer.join();
+		}
+
+		while (counter.load() != PRODUCERS * TASKS)
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	assert(counter.load() == PRODUCERS * TASKS);
+}
+
+void test_TypedQueueExecutor()
+{
+	test_TypedQueueExecutor_ring();
+	test_TypedQueueExecutor_post();
+	test_TypedQueueExecutor_release();
+	test_TypedQueueExecutor_single_thread();
+	test_TypedQueueExecutor_threads();
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "test.hpp"
+#include <adl/when_all.h>
+#include <adl/channel_thread.h>
+#include <adl/executors/queue_executor.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <variant>
+
+namespace
+{
+	enum class JoinChannelType : int
+	{
+		Q1 = 1,
+		Q2 = 2,
+		J = 3,
+		T1 = 4,
+		T2 = 5,
+	};
+
+	using Channel_Q1 = adl::Channel<JoinChannelType, JoinChannelType::Q1, adl::QueueExecutor>;
+	using Channel_Q2 = adl::Channel<JoinChannelType, JoinChannelType::Q2, adl::QueueExecutor>;
+	using Channel_J = adl::Channel<JoinChannelType, JoinChannelType::J, adl::QueueExecutor>;
+
+	// Dispatched in separate threads
+	using Channel_T1 = adl::Channel<JoinChannelType, JoinChannelType::T1, adl::LockFreeQueueExecutor>;
+	using Channel_T2 = adl::Channel<JoinChannelType, JoinChannelType::T2, adl::LockFreeQueueExecutor>;
+}
+
+void test_WhenAll_all()
+{
+	{
+		std::tuple<size_t, std::string, adl::placeholder> joined;
+		bool invoked = false;
+
+		adl::when_all<Channel_J>(
+			adl::task<Channel_Q1>([] { return size_t{ 1 }; }).then<Channel_Q2>(&add<2>),
+			adl::task<Channel_Q2>([] { return std::string{ "two" }; }),
+			adl::task<Channel_Q1>([] {}))
+			.then<Channel_J>([&joined, &invoked](std::tuple<size_t, std::string, adl::placeholder> results) { joined = std::move(results); invoked = true; })
+			.submit();
+
+		adl::dispatch<Channel_Q1>();
+		adl::dispatch<Channel_J>();
+		assert(!invoked);
+
+		// Continuation is posted to the join channel by the last completed task
+		adl::dispatch<Channel_Q2>();
+		assert(!invoked);
+
+		adl::dispatch<Channel_J>();
+		assert(invoked);
+		assert(std::get<0>(joined) == 3);
+		assert(std::get<1>(joined) == "two");
+	}
+
+	{
+		// Joined task is continued like any other task
+		size_t sum = 0;
+
+		adl::when_all<Channel_J>(
+			adl::task<Channel_Q1>([] { return std::make_shared<size_t>(10); }),
+			adl::task<Channel_Q2>([] { return size_t{ 5 }; }))
+			.then<Channel_Q1>([](std::tuple<std::shared_ptr<size_t>, size_t> results) { return *std::get<0>(results) + std::get<1>(results); })
+			.then<Channel_Q2>([&sum](size_t value) { sum = value; })
+			.submit();
+
+		adl::dispatch<Channel_Q1>();
+		adl::dispatch<Channel_Q2>();
+		adl::dispatch<Channel_J>();
+		adl::dispatch<Channel_Q1>();
+		adl::dispatch<Channel_Q2>();
+
+		assert(sum == 15);
+	}
+
+	{
+		// Tasks are executed by their channel threads and joined without blocking
+		constexpr size_t JOINS = 1000;
+
+		adl::ChannelThread<Channel_T1> t1;
+		adl::ChannelThread<Channel_T2> t2;
+
+		std::atomic_size_t joined{ 0 };
+
+		for (size_t i = 0; i < JOINS; ++i)
+		{
+			adl::when_all<Channel_J>(
+				adl::task<Channel_T1>([i] { return i; }),
+				adl::task<Channel_T2>([i] { return i * 2; }))
+				.then([&joined, i](std::tuple<size_t, size_t> results) { assert(std::get<0>(results) == i && std::get<1>(results) == i * 2); joined.fetch_add(1); })
+				.submit();
+		}
+
+		while (joined.load() != JOINS)
+		{
+			adl::dispatch<Channel_J>();
+			std::this_thread::yield();
+		}
+	}
+}
+
+void test_WhenAll_any()
+{
+	{
+		// The first completed task continues, others complete without it
+		size_t first = 0;
+		size_t invocations = 0;
+
+		adl::when_any<Channel_J>(
+			adl::task<Channel_Q1>([] { return size_t{ 1 }; }),
+			adl::task<Channel_Q2>([] { return size_t{ 2 }; }))
+			.then<Channel_J>([&first, &invocations](size_t result) { first = result; ++invocations; })
+			.submit();
+
+		adl::dispatch<Channel_Q2>();
+		adl::dispatch<Channel_J>();
+		assert(first == 2);
+
+		adl::dispatch<Channel_Q1>();
+		adl::dispatch<Channel_J>();
+		assert(first == 2);
+		assert(invocations == 1);
+	}
+
+	{
+		// Different result types are passed as a variant with the index of the completed task
+		std::variant<size_t, std::string> first;
+
+		adl::when_any<Channel_J>(
+			adl::task<Channel_Q1>([] { return size_t{ 1 }; }),
+			adl::task<Channel_Q2>([] { return std::string{ "two" }; }))
+			.then<Channel_J>([&first](std::variant<size_t, std::string> result) { first = std::move(result); })
+			.submit();
+
+		adl::dispatch<Channel_Q1>();
+		adl::dispatch<Channel_Q2>();
+		adl::dispatch<Channel_J>();
+
+		assert(first.index() == 0 && std::get<0>(first) == 1);
+	}
+}
+
+void test_WhenAll()
+{
+	test_WhenAll_all();
+	test_WhenAll_any();
+}
\ No newline at end of file